@@ -1,7 +1,14 @@
 #include "scene_client.h"
 #include "scene_loader.h"
 #include "scene_scheduler.h"
+#include "scene_catalog.h"
+#include "navigation_model.h"
+#include "render_world.h"
 #include "gl_renderer.h"
+#include "mesh_registry.h"
+#include "render_queue.h"
+#include "gl_upload_thread.h"
+#include "render_thread.h"
 #include "scene_types.h"
 #include "camera.h"
 
@@ -12,6 +19,8 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <chrono>
+#include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <queue>
@@ -32,9 +41,19 @@ enum class ViewMode { SHOW_NONE, SHOW_SINGLE, SHOW_ALL };
 
 int main(int argc, char** argv) {
     // Setup gRPC channel to server
+    // Usage: P4_Client [server_addr] [resident_scenes] [worker_threads] [connections] [upload_thread]  (0 keeps the default)
     std::string server_addr = (argc > 1) ? argv[1] : "localhost:50051";
-    auto channel = grpc::CreateChannel(server_addr, grpc::InsecureChannelCredentials());
-    SceneClient client(channel);
+    int resident_scenes = (argc > 2) ? std::atoi(argv[2]) : 0;
+    size_t worker_threads = (argc > 3) ? static_cast<size_t>(std::max(0, std::atoi(argv[3]))) : 0;
+    int connections = (argc > 4) ? std::atoi(argv[4]) : 0;
+    // 1 = fill mesh buffers on a dedicated thread with its own shared GL context.
+    bool upload_thread = (argc > 5) && std::atoi(argv[5]) != 0;
+    if (resident_scenes <= 0) resident_scenes = 5;
+    if (connections <= 0) connections = 4;
+    // Several TCP connections so bulk downloads aren't capped by one congestion window.
+    SceneClient client(SceneClient::CreateChannelPool(server_addr, static_cast<size_t>(connections)));
+    // Connect while the window and GL come up; the first manifest then goes out on a warm channel.
+    std::jthread warmup([&client]() { client.WarmUp(std::chrono::seconds(3)); });
 
     // GL + window init
     if (!glfwInit()) return 1;
@@ -58,26 +77,45 @@ int main(int argc, char** argv) {
 
     // Renderer + upload queue which main thread will execute
     GLRenderer renderer;
-    renderer.Init();
+    renderer.Init("tmp/shader_cache");
     // Attempt to load skybox from the runtime's "Skybox" folder (the application runtime dir is out/build/x64-debug)
     if (!renderer.LoadSkybox("Skybox")) {
         std::cerr << "[Main] Skybox load failed or not present (expected folder: out/build/x64-debug/Skybox)\n";
     }
+    // Meshes are shared by content hash across scenes; scenes hold references, not meshes.
+    MeshRegistry mesh_registry(&renderer);
     std::queue<GLUploadTask> upload_queue;
     std::mutex upload_mtx;
     std::condition_variable upload_cv;
 
     // Scene loader & scheduler
-    SceneLoader loader(&client, &renderer, upload_queue, upload_mtx, upload_cv, "tmp");
-    SceneScheduler scheduler(&loader);
-
-    // Register a few scene ids (example)
-    scheduler.RegisterScene("scene01");
-    scheduler.RegisterScene("scene02");
-    scheduler.RegisterScene("scene03");
-    scheduler.RegisterScene("scene04");
-    scheduler.RegisterScene("scene05");
-    scheduler.Start();
+    // Worker count 0 = one per core; download/parse concurrency then adapts to measured throughput.
+    SceneLoader loader(&client, &mesh_registry, upload_queue, upload_mtx, upload_cv, "tmp", worker_threads);
+    GLUploadThread uploader(window);
+    if (upload_thread && uploader.Start()) loader.SetUploadThread(&uploader);
+    // Draws published frames and runs the loader's GL uploads once started (just before the main loop).
+    RenderThread render_thread(window, &renderer, upload_queue, upload_mtx);
+    // Navigation history drives prefetching of the scenes usually viewed next (saved on scheduler Stop).
+    NavigationModel nav_model("tmp/navigation.txt");
+    if (!nav_model.Load()) std::cerr << "[Main] Navigation history had malformed lines; kept the rest\n";
+    SceneScheduler scheduler(&loader, &nav_model, resident_scenes);
+
+    // Scenes come from the server's catalog (ordered by id). If it can't be listed yet, start with
+    // the default scene ids; the catalog watcher adds the real ones once the server answers.
+    if (warmup.joinable()) warmup.join(); // bounded by the warm-up timeout
+    SceneCatalog catalog(&client);
+    std::vector<scene::SceneSummary> catalog_scenes;
+    if (catalog.LoadInitial(catalog_scenes)) {
+        for (auto& s : catalog_scenes) scheduler.RegisterScene(s.scene_id());
+    } else {
+        std::cerr << "[Main] Scene catalog unavailable, using default scene ids\n";
+        for (const char* id : { "scene01", "scene02", "scene03", "scene04", "scene05" }) scheduler.RegisterScene(id);
+    }
+
+    // Render-side SoA copy of uploaded models; slots follow registration order (scenes added
+    // later by the catalog get the next free slot).
+    RenderWorld world;
+    for (auto& sd : scheduler.GetAllScenes()) world.AddScene(sd->scene_id);
 
     Camera camera;
     std::string view_scene_id;
@@ -97,6 +135,43 @@ int main(int argc, char** argv) {
     };
     const float maxPlacementDistance = 10.0f; // clamp to this world-space distance from scene base offset
 
+    // Placement is a pure function of (scene, model index), so RenderWorld evaluates it once per
+    // model when it arrives and caches the resulting world matrix.
+    world.SetPlacement([&](const std::string& scene_id, uint16_t scene_index, uint32_t model_index) {
+        // choose base offset per scene (for grouping)
+        glm::vec3 scene_base = glm::vec3(scene_index * scene_spacing, 0.0f, 0.0f);
+
+        // Deterministic "random" placement selected from predefinedOffsets.
+        // Seed uses scene_id and model index so placement is stable across frames/runs.
+        size_t seed = std::hash<std::string>{}(scene_id) ^ (static_cast<size_t>(model_index) * 0x9e3779b97f4a7c15ULL);
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(predefinedOffsets.size()) - 1);
+        glm::vec3 chosen = predefinedOffsets[dist(rng)];
+
+        // Optionally add small jitter (clamped)
+        std::uniform_real_distribution<float> jitterDist(-0.25f, 0.25f);
+        float jx = jitterDist(rng);
+        float jz = jitterDist(rng);
+        chosen += glm::vec3(jx, 0.0f, jz);
+
+        // Clamp distance from scene_base
+        glm::vec3 worldPos = scene_base + chosen;
+        float distLen = glm::length(glm::vec3(worldPos.x - scene_base.x, 0.0f, worldPos.z - scene_base.z));
+        if (distLen > maxPlacementDistance) {
+            glm::vec3 dir = glm::normalize(glm::vec3(worldPos.x - scene_base.x, 0.0f, worldPos.z - scene_base.z));
+            worldPos = scene_base + dir * maxPlacementDistance;
+        }
+        return worldPos;
+    });
+    loader.SetRenderWorld(&world);
+    // All manifests in one round trip, streamed in registration order; loads that start before
+    // their manifest arrives fetch it themselves.
+    std::vector<std::string> prefetch_ids;
+    for (auto& sd : scheduler.GetAllScenes()) prefetch_ids.push_back(sd->scene_id);
+    std::jthread manifest_prefetch([&loader, prefetch_ids]() { loader.PrefetchManifests(prefetch_ids); });
+    scheduler.Start();
+    catalog.StartWatching();
+
     // Modal popup state
     bool open_loading_all_modal = false;
     bool open_loading_scene_modal = false;
@@ -129,6 +204,27 @@ int main(int argc, char** argv) {
         }
     };
 
+    // Cancel a scene's load and free its GL meshes (uploads still queued for it see the cancel and skip).
+    // The meshes are released on the render thread, after the frames that may still draw them.
+    auto UnloadSceneResources = [&](const std::shared_ptr<SceneDescriptor>& sd) {
+        scheduler.UnloadScene(sd->scene_id);
+        std::vector<MeshHandle> handles;
+        {
+            std::scoped_lock lk(sd->mtx);
+            handles.swap(sd->mesh_handles);
+            world.PostSceneCleared(sd->scene_id);
+        }
+        render_thread.PostGL([&mesh_registry, handles = std::move(handles)]() mutable {
+            for (auto &mh : handles) mesh_registry.Release(mh);
+        });
+    };
+    auto FindScene = [&](const std::string& scene_id) -> std::shared_ptr<SceneDescriptor> {
+        for (auto& sd : scheduler.GetAllScenes()) {
+            if (sd->scene_id == scene_id) return sd;
+        }
+        return nullptr;
+    };
+
     // tracking to avoid log floods
     float last_logged_pct_all = -1.0f;
     auto last_logged_all_time = std::chrono::high_resolution_clock::now();
@@ -168,6 +264,10 @@ int main(int argc, char** argv) {
     auto last = clock::now();
     double fps = 0.0;
     double frame_time_avg = 0.0;
+    // ImGui creates its GL objects lazily in its first NewFrame; do it now, while this thread
+    // still owns the context, so the main loop never touches GL.
+    ImGui_ImplOpenGL3_CreateDeviceObjects();
+    render_thread.Start();
 
     // Main loop
     AppendLog("App started");
@@ -192,13 +292,41 @@ int main(int argc, char** argv) {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        // Execute pending GL upload tasks (created by loader)
-        {
-            std::scoped_lock lk(upload_mtx);
-            while (!upload_queue.empty()) {
-                auto task = std::move(upload_queue.front());
-                upload_queue.pop();
-                task();
+        // Apply catalog changes pushed by the server. A changed scene is unloaded so the
+        // scheduler loads it again with the new manifest.
+        for (auto& change : catalog.TakeChanges()) {
+            const std::string& id = change.scene().scene_id();
+            switch (change.kind()) {
+            case scene::SceneChange::ADDED:
+                scheduler.RegisterScene(id);
+                world.AddScene(id);
+                AppendLog(std::string("Catalog: scene added ") + id);
+                break;
+            case scene::SceneChange::CHANGED:
+                loader.InvalidateManifest(id);
+                if (auto sd = FindScene(id)) {
+                    if (sd->state.load() != SceneState::UNLOADED) UnloadSceneResources(sd);
+                } else {
+                    scheduler.RegisterScene(id);
+                    world.AddScene(id);
+                }
+                AppendLog(std::string("Catalog: scene changed ") + id);
+                break;
+            case scene::SceneChange::REMOVED:
+                loader.InvalidateManifest(id);
+                if (auto sd = FindScene(id)) {
+                    UnloadSceneResources(sd);
+                    scheduler.RemoveScene(id);
+                }
+                if (view_scene_id == id) {
+                    view_mode = ViewMode::SHOW_NONE;
+                    view_scene_id.clear();
+                }
+                if (loading_scene_id == id) open_loading_scene_modal = false;
+                AppendLog(std::string("Catalog: scene removed ") + id);
+                break;
+            default:
+                break;
             }
         }
 
@@ -264,20 +392,17 @@ int main(int argc, char** argv) {
 
             if (ImGui::Button("Load")) {
                 if (sd->state.load() == SceneState::UNLOADED) {
-                    loader.EnqueueLoad(sd);
-                    AppendLog(std::string("Enqueued load for scene ") + sd->scene_id);
+                    if (loader.EnqueueLoad(sd))
+                        AppendLog(std::string("Enqueued load for scene ") + sd->scene_id);
+                    else
+                        AppendLog(std::string("Scene ") + sd->scene_id + " is still cancelling its previous load");
                 }
             }
             ImGui::SameLine();
             if (ImGui::Button("Unload")) {
-                scheduler.UnloadScene(sd->scene_id);
+                // cancels in-flight downloads/parses/uploads for this scene only
+                UnloadSceneResources(sd);
                 AppendLog(std::string("Unload requested for scene ") + sd->scene_id);
-                // free GL resources
-                std::scoped_lock lk(sd->mtx);
-                for (auto &mh : sd->mesh_handles) {
-                    renderer.DestroyMesh(mh);
-                }
-                sd->mesh_handles.clear();
             }
             ImGui::SameLine();
             if (ImGui::Button("View")) {
@@ -330,15 +455,19 @@ int main(int argc, char** argv) {
                     if (ImGui::Button("Prev")) {
                         idx = (idx - 1 + model_count) % model_count;
                         sd->current_model_index.store(idx);
+                        world.PostActiveModel(sd->scene_id, idx);
                     }
                     ImGui::SameLine();
                     if (ImGui::Button("Next")) {
                         idx = (idx + 1) % model_count;
                         sd->current_model_index.store(idx);
+                        world.PostActiveModel(sd->scene_id, idx);
                     }
                     ImGui::SameLine();
                     const std::string& name = sd->models[idx].name.empty() ? sd->models[idx].rel_path : sd->models[idx].name;
-                    ImGui::Text("%d/%d: %s", idx + 1, model_count, name.c_str());
+                    int64_t tris = sd->models[idx].triangle_count;
+                    if (tris > 0) ImGui::Text("%d/%d: %s (%lld tris)", idx + 1, model_count, name.c_str(), static_cast<long long>(tris));
+                    else ImGui::Text("%d/%d: %s", idx + 1, model_count, name.c_str());
                 } else {
                     ImGui::Text("No models");
                 }
@@ -353,7 +482,9 @@ int main(int argc, char** argv) {
         frame_time_avg = 0.9 * frame_time_avg + 0.1 * dt;
         fps = (frame_time_avg > 0.0) ? 1.0 / frame_time_avg : 0.0;
         ImGui::Begin("Debug");
-        ImGui::Text("FPS: %.1f", fps);
+        ImGui::Text("FPS: %.1f (render %.2f ms)", fps, render_thread.LastFrameMs());
+        ImGui::Text("Meshes: %zu (%zu refs, %.1f MiB)", mesh_registry.MeshCount(), mesh_registry.ReferenceCount(),
+                    mesh_registry.ResidentBytes() / (1024.0 * 1024.0));
         ImGui::Text("Cam pos: (%.2f, %.2f, %.2f)", camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z);
         ImGui::Text("View mode: %s", (view_mode == ViewMode::SHOW_ALL) ? "All" : (view_mode == ViewMode::SHOW_SINGLE) ? view_scene_id.c_str() : "None");
         ImGui::End();
@@ -642,101 +773,62 @@ int main(int argc, char** argv) {
 
         ImGui::End();
 
-        // Render
+        // Build the frame for the render thread
         glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.1f, 0.12f, 0.15f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_DEPTH_TEST);
+        FramePacket& frame = render_thread.Frame();
+        frame.display_w = display_w;
+        frame.display_h = display_h;
 
         // Build view/projection from camera
         auto view = camera.GetViewMatrix();
         auto proj = camera.GetProjectionMatrix((float)display_w / (float)display_h);
         glm::mat4 viewProj = proj * view;
-
-        // Determine base offset index for scene05 (all hidden models spawn here)
-        int base_index = 4; // default to scene05 (registration order)
-        {
-            auto all_scenes = scheduler.GetAllScenes();
-            for (int i = 0; i < (int)all_scenes.size(); ++i) {
-                if (all_scenes[i]->scene_id == "scene05") { base_index = i; break; }
-            }
-        }
-        glm::vec3 base_offset = glm::vec3(base_index * scene_spacing, 0.0f, 0.0f);
-
-        // Render skybox first (so it sits behind everything)
-        renderer.RenderSkybox(view, proj);
-
-        // Render a flat ground plane under models
-        renderer.RenderPlane(viewProj, glm::vec3(0.35f, 0.35f, 0.38f));
+        frame.view = view;
+        frame.proj = proj;
 
         // Render logic:
         // - SHOW_NONE: render nothing (models are loaded & uploaded but hidden)
         // - SHOW_SINGLE: render only selected scene's active model at base_offset (same place as scene05)
         // - SHOW_ALL: render every loaded scene's active model at its own small offset (scene_index * spacing)
+        // The sweep reads RenderWorld's arrays only: no descriptor locks or shared_ptr chasing per frame,
+        // and world matrices are cached (rebuilt only when a model changes).
+        // Everything goes through the render queue, which orders it by pass, program, mesh and depth:
+        // models front to back, then the ground plane, then the skybox behind all of it.
         {
-            int scene_index = 0;
-            auto all_scenes = scheduler.GetAllScenes();
-            for (auto& sd : all_scenes) {
-                if (sd->state.load() != SceneState::LOADED) { ++scene_index; continue; }
-
-                // decide whether to render this scene
-                if (view_mode == ViewMode::SHOW_NONE) { ++scene_index; continue; }
-                if (view_mode == ViewMode::SHOW_SINGLE && sd->scene_id != view_scene_id) { ++scene_index; continue; }
-
-                std::scoped_lock lk(sd->mtx);
-                int active = sd->current_model_index.load();
-                if (active < 0) active = 0;
-                if (active >= (int)sd->mesh_handles.size()) { ++scene_index; continue; }
-
-                const MeshHandle& mh = sd->mesh_handles[active];
-                if (mh.vao == 0) { ++scene_index; continue; }
-
-                glm::mat4 modelLocal = (sd->model_transforms.size() > (size_t)active) ? sd->model_transforms[active] : glm::mat4(1.0f);
-
-                // choose base offset per scene (for grouping)
-                glm::vec3 scene_base = glm::vec3(scene_index * scene_spacing, 0.0f, 0.0f);
-
-                // For each model compute a deterministic "random" placement selected from predefinedOffsets.
-                // Seed uses scene_id and model index so placement is stable across frames/runs.
-                size_t seed = std::hash<std::string>{}(sd->scene_id) ^ (static_cast<size_t>(active) * 0x9e3779b97f4a7c15ULL);
-                std::mt19937_64 rng(seed);
-                std::uniform_int_distribution<int> dist(0, static_cast<int>(predefinedOffsets.size()) - 1);
-                glm::vec3 chosen = predefinedOffsets[dist(rng)];
-
-                // Optionally add small jitter (clamped)
-                std::uniform_real_distribution<float> jitterDist(-0.25f, 0.25f);
-                float jx = jitterDist(rng);
-                float jz = jitterDist(rng);
-                chosen += glm::vec3(jx, 0.0f, jz);
-
-                // Clamp distance from scene_base
-                glm::vec3 worldPos = scene_base + chosen;
-                float distLen = glm::length(glm::vec3(worldPos.x - scene_base.x, 0.0f, worldPos.z - scene_base.z));
-                if (distLen > maxPlacementDistance) {
-                    glm::vec3 dir = glm::normalize(glm::vec3(worldPos.x - scene_base.x, 0.0f, worldPos.z - scene_base.z));
-                    worldPos = scene_base + dir * maxPlacementDistance;
-                }
-
-                // Final model matrix: translate by worldPos then apply local model transform
-                glm::mat4 model = glm::translate(glm::mat4(1.0f), worldPos) * modelLocal;
-
-                // keep vertical alignment if necessary (preserve Y)
-                model[3].y = worldPos.y;
-
-                renderer.RenderMesh(mh, model, viewProj, glm::vec3(0.8f, 0.8f, 0.9f));
-                ++scene_index;
+            world.ApplyEvents();
+            world.SetViewFilter(view_mode != ViewMode::SHOW_NONE,
+                                view_mode == ViewMode::SHOW_SINGLE ? view_scene_id : std::string());
+            RenderQueue& render_queue = frame.queue;
+            render_queue.Clear();
+            // BVH frustum query: off-screen models are skipped without touching them.
+            Frustum frustum = Frustum::FromViewProj(viewProj);
+            const glm::vec3 model_color(0.8f, 0.8f, 0.9f);
+            for (uint32_t i : world.CullVisible(frustum)) {
+                // View space looks down -z, so the distance in front of the camera is -z.
+                float depth = -(view * glm::vec4(world.WorldCenter(i), 1.0f)).z;
+                render_queue.SubmitMesh(world.Mesh(i), world.WorldMatrix(i), depth, model_color);
             }
+            render_queue.SubmitPlane(glm::vec3(0.35f, 0.35f, 0.38f));
+            render_queue.SubmitSkybox();
+            render_queue.Sort();
         }
 
-        // Render ImGui on top
+        // ImGui on top (drawn by the render thread from a copy)
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        frame.SetUi(ImGui::GetDrawData());
+        render_thread.Publish();
     }
 
     AppendLog("App exiting - initiating graceful shutdown");
 
+    // 0) Stop the render thread; GL work from here on runs on this thread again.
+    render_thread.Stop();
+    AppendLog("Render thread stopped");
+
+    // 0b) Stop following the catalog (aborts the open watch stream).
+    catalog.Stop();
+    AppendLog("Catalog watcher stopped");
+
     // 1) Stop scheduler so it won't enqueue new work or request new downloads.
     try {
         scheduler.Stop();
@@ -751,25 +843,33 @@ int main(int argc, char** argv) {
     upload_cv.notify_all();
     AppendLog("Notified upload_cv to wake any waiting threads");
 
+    // 2b) Stop the upload thread: finished uploads and the failures of queued ones resume their
+    //     loads through upload_queue, which the drain below runs.
+    uploader.Stop();
+    AppendLog("Upload thread stopped");
+
     // 3) Drain remaining GL upload tasks on the main thread before shutting down the loader/renderer.
     //    This ensures no background thread will attempt GL calls after we tear down the GL context.
     {
         auto drain_start = clock::now();
         while (true) {
-            bool didWork = false;
+            // Swap the batch out and run it unlocked: tasks resume loader coroutines, and a
+            // coroutine hopping to the main thread again posts (locks upload_mtx) from inside one.
+            std::queue<GLUploadTask> pending;
             {
                 std::scoped_lock lk(upload_mtx);
-                while (!upload_queue.empty()) {
-                    didWork = true;
-                    try {
-                        auto task = std::move(upload_queue.front());
-                        upload_queue.pop();
-                        task(); // perform GL upload on main thread
-                    } catch (const std::exception& ex) {
-                        AppendLog(std::string("Exception in upload task: ") + ex.what());
-                    } catch (...) {
-                        AppendLog("Unknown exception executing upload task");
-                    }
+                pending.swap(upload_queue);
+            }
+            bool didWork = !pending.empty();
+            while (!pending.empty()) {
+                try {
+                    auto task = std::move(pending.front());
+                    pending.pop();
+                    task(); // perform GL upload on main thread
+                } catch (const std::exception& ex) {
+                    AppendLog(std::string("Exception in upload task: ") + ex.what());
+                } catch (...) {
+                    AppendLog("Unknown exception executing upload task");
                 }
             }
             if (!didWork) break;
@@ -799,10 +899,11 @@ int main(int argc, char** argv) {
         for (auto &sd : all_scenes) {
             std::scoped_lock lk(sd->mtx);
             for (auto &mh : sd->mesh_handles) {
-                renderer.DestroyMesh(mh);
+                mesh_registry.Release(mh);
             }
             sd->mesh_handles.clear();
         }
+        mesh_registry.DestroyAll();
         AppendLog("Destroyed scene mesh handles");
     } catch (const std::exception& ex) {
         AppendLog(std::string("Exception while destroying meshes: ") + ex.what());
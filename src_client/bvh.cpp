@@ -0,0 +1,175 @@
+#include "bvh.h"
+
+int32_t DynamicBVH::AllocateNode() {
+    if (free_list_ == kNull) {
+        nodes_.emplace_back();
+        return static_cast<int32_t>(nodes_.size() - 1);
+    }
+    int32_t i = free_list_;
+    free_list_ = nodes_[i].parent;
+    nodes_[i] = Node{};
+    return i;
+}
+
+void DynamicBVH::FreeNode(int32_t i) {
+    nodes_[i].parent = free_list_;
+    nodes_[i].height = -1;
+    free_list_ = i;
+}
+
+int32_t DynamicBVH::Insert(const Aabb& box, uint32_t user_data) {
+    int32_t leaf = AllocateNode();
+    nodes_[leaf].box = box;
+    nodes_[leaf].user = user_data;
+    nodes_[leaf].height = 0;
+    InsertLeaf(leaf);
+    ++leaf_count_;
+    return leaf;
+}
+
+void DynamicBVH::Remove(int32_t proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --leaf_count_;
+}
+
+void DynamicBVH::Update(int32_t proxy, const Aabb& box) {
+    const Aabb& cur = nodes_[proxy].box;
+    if (cur.min == box.min && cur.max == box.max) return;
+    RemoveLeaf(proxy);
+    nodes_[proxy].box = box;
+    InsertLeaf(proxy);
+}
+
+void DynamicBVH::InsertLeaf(int32_t leaf) {
+    if (root_ == kNull) {
+        root_ = leaf;
+        nodes_[leaf].parent = kNull;
+        return;
+    }
+
+    // Find the best sibling: descend while pairing here costs more than pushing the leaf into a
+    // child. Cost is surface area of the new parent plus the growth inherited by ancestors.
+    Aabb leaf_box = nodes_[leaf].box;
+    int32_t index = root_;
+    while (!nodes_[index].IsLeaf()) {
+        const Node& n = nodes_[index];
+        float area = n.box.SurfaceArea();
+        float combined_area = Aabb::Union(n.box, leaf_box).SurfaceArea();
+        float cost = 2.0f * combined_area;
+        float inheritance = 2.0f * (combined_area - area);
+
+        auto child_cost = [&](int32_t c) {
+            const Node& cn = nodes_[c];
+            float merged = Aabb::Union(cn.box, leaf_box).SurfaceArea();
+            return cn.IsLeaf() ? merged + inheritance : (merged - cn.box.SurfaceArea()) + inheritance;
+        };
+        float cost_left = child_cost(n.left);
+        float cost_right = child_cost(n.right);
+
+        if (cost < cost_left && cost < cost_right) break;
+        index = (cost_left < cost_right) ? n.left : n.right;
+    }
+
+    int32_t sibling = index;
+    int32_t old_parent = nodes_[sibling].parent;
+    int32_t new_parent = AllocateNode(); // may reallocate nodes_: no references held across this
+    nodes_[new_parent].parent = old_parent;
+    nodes_[new_parent].box = Aabb::Union(leaf_box, nodes_[sibling].box);
+    nodes_[new_parent].height = nodes_[sibling].height + 1;
+    nodes_[new_parent].left = sibling;
+    nodes_[new_parent].right = leaf;
+    nodes_[sibling].parent = new_parent;
+    nodes_[leaf].parent = new_parent;
+
+    if (old_parent != kNull) {
+        if (nodes_[old_parent].left == sibling) nodes_[old_parent].left = new_parent;
+        else nodes_[old_parent].right = new_parent;
+    } else {
+        root_ = new_parent;
+    }
+
+    RefitUpwards(nodes_[leaf].parent);
+}
+
+void DynamicBVH::RemoveLeaf(int32_t leaf) {
+    if (leaf == root_) {
+        root_ = kNull;
+        return;
+    }
+
+    int32_t parent = nodes_[leaf].parent;
+    int32_t grand_parent = nodes_[parent].parent;
+    int32_t sibling = (nodes_[parent].left == leaf) ? nodes_[parent].right : nodes_[parent].left;
+
+    if (grand_parent != kNull) {
+        if (nodes_[grand_parent].left == parent) nodes_[grand_parent].left = sibling;
+        else nodes_[grand_parent].right = sibling;
+        nodes_[sibling].parent = grand_parent;
+        FreeNode(parent);
+        RefitUpwards(grand_parent);
+    } else {
+        root_ = sibling;
+        nodes_[sibling].parent = kNull;
+        FreeNode(parent);
+    }
+}
+
+// Rebalance and refit every ancestor from i to the root.
+void DynamicBVH::RefitUpwards(int32_t i) {
+    while (i != kNull) {
+        i = Balance(i);
+        Node& n = nodes_[i];
+        n.height = 1 + std::max(nodes_[n.left].height, nodes_[n.right].height);
+        n.box = Aabb::Union(nodes_[n.left].box, nodes_[n.right].box);
+        i = n.parent;
+    }
+}
+
+// If one subtree of a is 2+ levels taller than the other, rotate its root up. Returns the
+// index of the node now at a's position.
+int32_t DynamicBVH::Balance(int32_t ia) {
+    Node& a = nodes_[ia];
+    if (a.IsLeaf() || a.height < 2) return ia;
+
+    int32_t ib = a.left;
+    int32_t ic = a.right;
+    int32_t balance = nodes_[ic].height - nodes_[ib].height;
+
+    // Promotes `iup` (a child of a) into a's place; `ikeep` is a's other child.
+    auto rotate_up = [&](int32_t iup, int32_t ikeep, bool up_was_right) -> int32_t {
+        Node& up = nodes_[iup];
+        int32_t if_ = up.left;
+        int32_t ig = up.right;
+
+        // up takes a's place under a's parent
+        up.left = ia;
+        up.parent = a.parent;
+        a.parent = iup;
+        if (up.parent != kNull) {
+            Node& p = nodes_[up.parent];
+            if (p.left == ia) p.left = iup;
+            else p.right = iup;
+        } else {
+            root_ = iup;
+        }
+
+        // the taller grandchild stays under up; the shorter one replaces up under a
+        int32_t stay = (nodes_[if_].height > nodes_[ig].height) ? if_ : ig;
+        int32_t move = (stay == if_) ? ig : if_;
+        up.right = stay;
+        if (up_was_right) a.right = move;
+        else a.left = move;
+        nodes_[move].parent = ia;
+
+        a.box = Aabb::Union(nodes_[ikeep].box, nodes_[move].box);
+        a.height = 1 + std::max(nodes_[ikeep].height, nodes_[move].height);
+        up.box = Aabb::Union(a.box, nodes_[stay].box);
+        up.height = 1 + std::max(a.height, nodes_[stay].height);
+        return iup;
+    };
+
+    if (balance > 1) return rotate_up(ic, ib, true);
+    if (balance < -1) return rotate_up(ib, ic, false);
+    return ia;
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/glm.hpp>
+
+struct Aabb {
+    glm::vec3 min{ 0.0f };
+    glm::vec3 max{ 0.0f };
+
+    static Aabb FromSphere(const glm::vec3& center, float radius) {
+        return { center - glm::vec3(radius), center + glm::vec3(radius) };
+    }
+    static Aabb Union(const Aabb& a, const Aabb& b) {
+        return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+    }
+    float SurfaceArea() const {
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+    bool Overlaps(const Aabb& o) const {
+        return min.x <= o.max.x && max.x >= o.min.x && min.y <= o.max.y && max.y >= o.min.y &&
+               min.z <= o.max.z && max.z >= o.min.z;
+    }
+    bool OverlapsSphere(const glm::vec3& c, float r) const {
+        glm::vec3 d = glm::max(min - c, glm::vec3(0.0f)) + glm::max(c - max, glm::vec3(0.0f));
+        return glm::dot(d, d) <= r * r;
+    }
+    // Slab test; on hit t_enter is the entry distance along dir (0 if origin is inside).
+    bool RayHit(const glm::vec3& origin, const glm::vec3& inv_dir, float max_t, float& t_enter) const {
+        float enter = 0.0f, exit = max_t;
+        for (int k = 0; k < 3; ++k) {
+            // Parallel to this slab (inv_dir is +-inf): inside it everywhere or nowhere. The slab
+            // formula would give 0 * inf = NaN for an origin on one of its planes.
+            if (std::isinf(inv_dir[k])) {
+                if (origin[k] < min[k] || origin[k] > max[k]) return false;
+                continue;
+            }
+            float t0 = (min[k] - origin[k]) * inv_dir[k];
+            float t1 = (max[k] - origin[k]) * inv_dir[k];
+            enter = std::max(enter, std::min(t0, t1));
+            exit = std::min(exit, std::max(t0, t1));
+        }
+        t_enter = enter;
+        return enter <= exit;
+    }
+};
+
+// View frustum as 6 inward-facing planes (dot(n, p) + d >= 0 inside), extracted from viewProj.
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum FromViewProj(const glm::mat4& vp) {
+        Frustum f;
+        glm::vec4 r0(vp[0][0], vp[1][0], vp[2][0], vp[3][0]);
+        glm::vec4 r1(vp[0][1], vp[1][1], vp[2][1], vp[3][1]);
+        glm::vec4 r2(vp[0][2], vp[1][2], vp[2][2], vp[3][2]);
+        glm::vec4 r3(vp[0][3], vp[1][3], vp[2][3], vp[3][3]);
+        f.planes[0] = r3 + r0; // left
+        f.planes[1] = r3 - r0; // right
+        f.planes[2] = r3 + r1; // bottom
+        f.planes[3] = r3 - r1; // top
+        f.planes[4] = r3 + r2; // near
+        f.planes[5] = r3 - r2; // far
+        return f;
+    }
+    // Conservative: may accept boxes just outside a frustum corner, never rejects visible ones.
+    bool Intersects(const Aabb& b) const {
+        for (const auto& p : planes) {
+            glm::vec3 positive(p.x >= 0.0f ? b.max.x : b.min.x, p.y >= 0.0f ? b.max.y : b.min.y, p.z >= 0.0f ? b.max.z : b.min.z);
+            if (p.x * positive.x + p.y * positive.y + p.z * positive.z + p.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
+// Dynamic bounding volume hierarchy over AABBs (incremental insert/remove, no rebuilds).
+// Insertion descends by surface-area cost, ancestors are refit on the way back up and kept
+// balanced with AVL-style rotations. Proxies are stable ids; user_data is caller-defined.
+class DynamicBVH {
+public:
+    static constexpr int32_t kNull = -1;
+
+    int32_t Insert(const Aabb& box, uint32_t user_data);
+    void Remove(int32_t proxy);
+    // Move a proxy to a new box (remove + reinsert only if it actually changed).
+    void Update(int32_t proxy, const Aabb& box);
+
+    uint32_t UserData(int32_t proxy) const { return nodes_[proxy].user; }
+    void SetUserData(int32_t proxy, uint32_t user_data) { nodes_[proxy].user = user_data; }
+    const Aabb& Bounds(int32_t proxy) const { return nodes_[proxy].box; }
+    size_t Size() const { return leaf_count_; }
+    int Height() const { return root_ == kNull ? 0 : nodes_[root_].height; }
+
+    // fn(user_data) for every leaf whose box intersects the frustum.
+    template <typename Fn>
+    void QueryFrustum(const Frustum& frustum, Fn&& fn) const {
+        Traverse([&](const Aabb& b) { return frustum.Intersects(b); }, fn);
+    }
+
+    // fn(user_data) for every leaf whose box overlaps the sphere.
+    template <typename Fn>
+    void QueryRadius(const glm::vec3& center, float radius, Fn&& fn) const {
+        Traverse([&](const Aabb& b) { return b.OverlapsSphere(center, radius); }, fn);
+    }
+
+    // fn(user_data, t_enter) -> float for every leaf box the ray enters before max_t. The return value
+    // becomes the new max_t, so returning the exact hit distance turns this into a nearest-hit search.
+    template <typename Fn>
+    void QueryRay(const glm::vec3& origin, const glm::vec3& dir, float max_t, Fn&& fn) const {
+        if (root_ == kNull) return;
+        glm::vec3 inv_dir(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+        int32_t stack[kMaxStack];
+        int sp = 0;
+        stack[sp++] = root_;
+        while (sp > 0) {
+            const Node& n = nodes_[stack[--sp]];
+            float t = 0.0f;
+            if (!n.box.RayHit(origin, inv_dir, max_t, t)) continue;
+            if (n.IsLeaf()) {
+                max_t = std::min(max_t, static_cast<float>(fn(n.user, t)));
+            } else {
+                stack[sp++] = n.left;
+                stack[sp++] = n.right;
+            }
+        }
+    }
+
+private:
+    // Depth-first stack bound: the tree is height-balanced, so depth stays ~1.44*log2(leaves).
+    static constexpr int kMaxStack = 256;
+
+    struct Node {
+        Aabb box;
+        int32_t parent = kNull; // next free node while on the free list
+        int32_t left = kNull;
+        int32_t right = kNull;
+        int32_t height = 0;     // leaf = 0, free = -1
+        uint32_t user = 0;
+        bool IsLeaf() const { return left == kNull; }
+    };
+
+    template <typename Pred, typename Fn>
+    void Traverse(Pred&& overlaps, Fn& fn) const {
+        if (root_ == kNull) return;
+        int32_t stack[kMaxStack];
+        int sp = 0;
+        stack[sp++] = root_;
+        while (sp > 0) {
+            const Node& n = nodes_[stack[--sp]];
+            if (!overlaps(n.box)) continue;
+            if (n.IsLeaf()) {
+                fn(n.user);
+            } else {
+                stack[sp++] = n.left;
+                stack[sp++] = n.right;
+            }
+        }
+    }
+
+    int32_t AllocateNode();
+    void FreeNode(int32_t i);
+    void InsertLeaf(int32_t leaf);
+    void RemoveLeaf(int32_t leaf);
+    void RefitUpwards(int32_t i);
+    int32_t Balance(int32_t a);
+
+    std::vector<Node> nodes_;
+    int32_t root_ = kNull;
+    int32_t free_list_ = kNull;
+    size_t leaf_count_ = 0;
+};
\ No newline at end of file
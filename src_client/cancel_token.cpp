@@ -0,0 +1,52 @@
+#include "cancel_token.h"
+#include <vector>
+
+std::shared_ptr<CancelToken> CancelToken::Create(const std::shared_ptr<CancelToken>& parent) {
+    std::shared_ptr<CancelToken> token(new CancelToken());
+    if (parent) {
+        token->parent_ = parent;
+        std::weak_ptr<CancelToken> weak = token;
+        token->parent_cb_ = parent->OnCancel([weak]() {
+            if (auto t = weak.lock()) t->Cancel();
+        });
+    }
+    return token;
+}
+
+CancelToken::~CancelToken() {
+    if (parent_cb_ != 0) {
+        if (auto p = parent_.lock()) p->Unregister(parent_cb_);
+    }
+}
+
+void CancelToken::Cancel() {
+    std::vector<std::function<void()>> to_run;
+    {
+        std::scoped_lock lk(mtx_);
+        if (cancelled_.exchange(true)) return;
+        to_run.reserve(callbacks_.size());
+        for (auto& kv : callbacks_) to_run.push_back(std::move(kv.second));
+        callbacks_.clear();
+    }
+    // Run outside the lock: callbacks may cancel children or unregister themselves.
+    for (auto& fn : to_run) fn();
+}
+
+CancelToken::CallbackId CancelToken::OnCancel(std::function<void()> fn) {
+    {
+        std::scoped_lock lk(mtx_);
+        if (!cancelled_.load()) {
+            CallbackId id = next_id_++;
+            callbacks_.emplace(id, std::move(fn));
+            return id;
+        }
+    }
+    fn();
+    return 0;
+}
+
+void CancelToken::Unregister(CallbackId id) {
+    if (id == 0) return;
+    std::scoped_lock lk(mtx_);
+    callbacks_.erase(id);
+}
\ No newline at end of file
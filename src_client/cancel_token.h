@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Shared cancellation flag with callbacks. Tokens form a tree (loader -> scene -> model):
+// cancelling a token cancels all of its children. Callbacks let in-flight work (e.g. gRPC
+// streams) abort immediately instead of waiting for the next poll.
+class CancelToken : public std::enable_shared_from_this<CancelToken> {
+public:
+    using CallbackId = uint64_t;
+
+    // Create a token; if parent is given the new token is cancelled together with it.
+    static std::shared_ptr<CancelToken> Create(const std::shared_ptr<CancelToken>& parent = nullptr);
+    ~CancelToken();
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    bool IsCancelled() const { return cancelled_.load(); }
+
+    // Idempotent. Runs registered callbacks on the calling thread.
+    void Cancel();
+
+    // Register fn to run on cancellation. If already cancelled fn runs immediately and 0 is returned.
+    // A callback may still be running when Unregister returns if Cancel races with it.
+    CallbackId OnCancel(std::function<void()> fn);
+    void Unregister(CallbackId id);
+
+private:
+    CancelToken() = default;
+
+    std::atomic<bool> cancelled_{ false };
+    std::mutex mtx_;
+    std::unordered_map<CallbackId, std::function<void()>> callbacks_;
+    CallbackId next_id_ = 1;
+
+    std::weak_ptr<CancelToken> parent_;
+    CallbackId parent_cb_ = 0;
+};
\ No newline at end of file
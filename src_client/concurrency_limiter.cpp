@@ -0,0 +1,56 @@
+#include "concurrency_limiter.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+constexpr double kShortAlpha = 0.5;  // recent samples
+constexpr double kLongAlpha = 0.05;  // baseline
+constexpr double kSmoothing = 0.2;   // how far one sample moves the limit
+constexpr double kBackoff = 0.9;     // multiplicative decrease on error
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(std::string name, size_t initial_limit, size_t min_limit, size_t max_limit)
+    : name_(std::move(name)), min_limit_(std::max<size_t>(1, min_limit)),
+      max_limit_(std::max(max_limit, std::max<size_t>(1, min_limit))) {
+    limit_ = static_cast<double>(std::clamp(initial_limit, min_limit_, max_limit_));
+    reported_limit_ = static_cast<size_t>(limit_);
+}
+
+size_t ConcurrencyLimiter::OnSample(std::chrono::steady_clock::duration latency, double cost, bool ok) {
+    std::scoped_lock lk(mtx_);
+    double new_limit = limit_;
+
+    if (!ok) {
+        new_limit = limit_ * kBackoff;
+    } else {
+        double seconds = std::chrono::duration<double>(latency).count();
+        double sample = seconds / std::max(cost / (1024.0 * 1024.0), 1e-3);
+        if (long_latency_ == 0.0) {
+            short_latency_ = long_latency_ = sample;
+        } else {
+            short_latency_ += kShortAlpha * (sample - short_latency_);
+            long_latency_ += kLongAlpha * (sample - long_latency_);
+        }
+        // Baseline far above recent samples means conditions improved; let it catch up quickly.
+        if (long_latency_ > 2.0 * short_latency_) long_latency_ *= 0.95;
+
+        double gradient = std::clamp(long_latency_ / std::max(short_latency_, 1e-9), 0.5, 1.0);
+        double queue_allowance = std::sqrt(limit_);
+        double target = limit_ * gradient + queue_allowance;
+        new_limit = limit_ * (1.0 - kSmoothing) + target * kSmoothing;
+    }
+
+    limit_ = std::clamp(new_limit, static_cast<double>(min_limit_), static_cast<double>(max_limit_));
+    size_t current = static_cast<size_t>(limit_);
+    if (current != reported_limit_) {
+        std::cerr << "[ConcurrencyLimiter] " << name_ << " limit " << reported_limit_ << " -> " << current << "\n";
+        reported_limit_ = current;
+    }
+    return current;
+}
+
+size_t ConcurrencyLimiter::Limit() const {
+    std::scoped_lock lk(mtx_);
+    return static_cast<size_t>(limit_);
+}
\ No newline at end of file
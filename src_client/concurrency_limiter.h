@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+// Adaptive concurrency limit (gradient algorithm in the style of TCP Vegas / Netflix concurrency-limits).
+// Each finished operation reports its latency normalised by its cost (e.g. seconds per MiB), which
+// makes operations of different size comparable. A slow-moving average tracks the uncongested
+// latency; when recent samples get slower than that, the limit shrinks proportionally, otherwise it
+// grows by ~sqrt(limit) per sample. Errors shrink it multiplicatively.
+class ConcurrencyLimiter {
+public:
+    ConcurrencyLimiter(std::string name, size_t initial_limit, size_t min_limit, size_t max_limit);
+
+    // Report one finished operation; returns the updated limit.
+    // cost: work units behind the latency (bytes); ok=false for failures (not cancellations).
+    size_t OnSample(std::chrono::steady_clock::duration latency, double cost, bool ok);
+
+    size_t Limit() const;
+
+private:
+    std::string name_;
+    size_t min_limit_;
+    size_t max_limit_;
+
+    mutable std::mutex mtx_;
+    double limit_;
+    double short_latency_ = 0.0; // fast EWMA of normalised latency
+    double long_latency_ = 0.0;  // slow EWMA: the "no queueing" baseline
+    size_t reported_limit_;      // last logged integer limit
+};
\ No newline at end of file
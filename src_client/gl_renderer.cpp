@@ -1,9 +1,12 @@
 #include "gl_renderer.h"
+#include "render_queue.h"
 #include <glad/glad.h>
 #include <iostream>
 #include <vector>
 #include <filesystem>
 #include <string>
+#include <algorithm>
+#include <cstring>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -15,33 +18,52 @@ static void LogGLErrorIfAny(const char* when) {
     }
 }
 
-static const char* kVS = R"(
-#version 330 core
+// Uniform blocks shared by every program. Binding points are fixed, so each block is attached
+// once after linking and never looked up again.
+static constexpr GLuint kFrameBlockBinding = 0;
+static constexpr GLuint kDrawBlockBinding = 1;
+
+#define P4_FRAME_BLOCK \
+    "layout(std140) uniform FrameConstants {\n" \
+    "    mat4 uView;\n" \
+    "    mat4 uProj;\n" \
+    "    mat4 uViewProj;\n" \
+    "    mat4 uSkyViewProj; // uProj * uView without translation\n" \
+    "};\n"
+#define P4_DRAW_BLOCK \
+    "layout(std140) uniform DrawConstants {\n" \
+    "    mat4 uModel;\n" \
+    "    vec4 uColor;\n" \
+    "};\n"
+
+static const char* kVS = "#version 330 core\n" P4_FRAME_BLOCK P4_DRAW_BLOCK R"(
 layout(location = 0) in vec3 aPos;
-uniform mat4 uMVP;
 void main() {
-    gl_Position = uMVP * vec4(aPos, 1.0);
+    gl_Position = uViewProj * uModel * vec4(aPos, 1.0);
 }
 )";
 
-static const char* kFS = R"(
-#version 330 core
+static const char* kFS = "#version 330 core\n" P4_DRAW_BLOCK R"(
 out vec4 FragColor;
-uniform vec3 uColor;
 void main() {
-    FragColor = vec4(uColor, 1.0);
+    FragColor = vec4(uColor.rgb, 1.0);
 }
 )";
 
-static const char* kSkyboxVS = R"(
-#version 330 core
+static const char* kInstancedVS = "#version 330 core\n" P4_FRAME_BLOCK R"(
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in mat4 aModel;
+void main() {
+    gl_Position = uViewProj * aModel * vec4(aPos, 1.0);
+}
+)";
+
+static const char* kSkyboxVS = "#version 330 core\n" P4_FRAME_BLOCK R"(
 layout(location = 0) in vec3 aPos;
 out vec3 TexCoords;
-uniform mat4 uView;
-uniform mat4 uProj;
 void main() {
     TexCoords = aPos;
-    vec4 pos = uProj * uView * vec4(aPos, 1.0);
+    vec4 pos = uSkyViewProj * vec4(aPos, 1.0);
     gl_Position = pos.xyww; // set depth to far plane
 }
 )";
@@ -56,12 +78,31 @@ void main() {
 }
 )";
 
+#undef P4_FRAME_BLOCK
+#undef P4_DRAW_BLOCK
+
 GLRenderer::GLRenderer() = default;
 GLRenderer::~GLRenderer() {
     if (program_) {
         glDeleteProgram(program_);
         std::cerr << "[GLRenderer] Deleted program " << program_ << "\n";
     }
+    if (instancedProgram_) {
+        glDeleteProgram(instancedProgram_);
+        std::cerr << "[GLRenderer] Deleted instanced program " << instancedProgram_ << "\n";
+    }
+    if (instanceVBO_) {
+        glDeleteBuffers(1, &instanceVBO_);
+        std::cerr << "[GLRenderer] Deleted instance VBO " << instanceVBO_ << "\n";
+    }
+    if (frameUBO_) {
+        glDeleteBuffers(1, &frameUBO_);
+        std::cerr << "[GLRenderer] Deleted frame UBO " << frameUBO_ << "\n";
+    }
+    if (drawUBO_) {
+        glDeleteBuffers(1, &drawUBO_);
+        std::cerr << "[GLRenderer] Deleted draw UBO " << drawUBO_ << "\n";
+    }
     if (skyboxProgram_) {
         glDeleteProgram(skyboxProgram_);
         std::cerr << "[GLRenderer] Deleted skybox program " << skyboxProgram_ << "\n";
@@ -84,15 +125,44 @@ GLRenderer::~GLRenderer() {
     if (planeVAO_) { glDeleteVertexArrays(1, &planeVAO_); std::cerr << "[GLRenderer] Deleted plane VAO " << planeVAO_ << "\n"; planeVAO_ = 0; }
 }
 
-void GLRenderer::Init() {
-    program_ = CreateProgram(kVS, kFS);
-    if (!program_) std::cerr << "[GLRenderer] Failed to create GL program\n";
-    else std::cerr << "[GLRenderer] Created GL program " << program_ << "\n";
-
+void GLRenderer::Init(const std::string& shader_cache_dir) {
+    // Programs first: with a cached binary they're ready at once, otherwise the driver can
+    // compile them (in parallel with GL_KHR_parallel_shader_compile) while the buffers below are
+    // set up. Nothing waits on a program until FinishProgram.
+    programCache_ = ProgramBinaryCache(shader_cache_dir);
+    programCache_.Init();
+#ifdef GL_KHR_parallel_shader_compile
+    if (GLAD_GL_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // driver's choice
+#endif
+    PendingProgram flat{ kVS, kFS };
+    // Same fragment stage; the model matrix comes per instance instead of per draw.
+    PendingProgram instanced{ kInstancedVS, kFS };
     // Create skybox program now (can be used even if no cubemap loaded)
-    skyboxProgram_ = CreateProgram(kSkyboxVS, kSkyboxFS);
-    if (!skyboxProgram_) std::cerr << "[GLRenderer] Failed to create skybox program\n";
-    else std::cerr << "[GLRenderer] Created skybox program " << skyboxProgram_ << "\n";
+    PendingProgram skybox{ kSkyboxVS, kSkyboxFS };
+    for (PendingProgram* pp : { &flat, &instanced, &skybox }) BeginProgram(*pp);
+
+    // Per-frame constants: one block, bound for the lifetime of the context.
+    glGenBuffers(1, &frameUBO_);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBlockBinding, frameUBO_);
+
+    // Per-draw constants: a ring of blocks, each at an offset the driver accepts for glBindBufferRange.
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    if (align <= 0) align = 256;
+    drawStride_ = (sizeof(DrawConstants) + align - 1) / align * align;
+    drawRingSize_ = drawStride_ * kDrawRingBlocks;
+    glGenBuffers(1, &drawUBO_);
+    glBindBuffer(GL_UNIFORM_BUFFER, drawUBO_);
+    glBufferData(GL_UNIFORM_BUFFER, drawRingSize_, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glGenBuffers(1, &instanceVBO_);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO_);
+    instanceCapacity_ = kInitialInstanceCapacity;
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity_ * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     // Create a simple large plane under the origin (XZ plane at Y = -1.0)
     // We'll create a quad of size 100x100 centered at origin.
@@ -120,122 +190,315 @@ void GLRenderer::Init() {
         glBindVertexArray(0);
     }
 
+    program_ = FinishProgram(flat);
+    if (!program_) std::cerr << "[GLRenderer] Failed to create GL program\n";
+    else std::cerr << "[GLRenderer] Created GL program " << program_ << "\n";
+
+    instancedProgram_ = FinishProgram(instanced);
+    if (!instancedProgram_) std::cerr << "[GLRenderer] Failed to create instanced program\n";
+    else std::cerr << "[GLRenderer] Created instanced program " << instancedProgram_ << "\n";
+
+    skyboxProgram_ = FinishProgram(skybox);
+    if (!skyboxProgram_) std::cerr << "[GLRenderer] Failed to create skybox program\n";
+    else {
+        std::cerr << "[GLRenderer] Created skybox program " << skyboxProgram_ << "\n";
+        // The cubemap always sits on unit 0; set the sampler once instead of per draw.
+        GLint locSampler = glGetUniformLocation(skyboxProgram_, "skybox");
+        if (locSampler >= 0) {
+            UseProgram(skyboxProgram_);
+            glUniform1i(locSampler, 0);
+        }
+    }
+
     LogGLErrorIfAny("Init");
 }
 
-uint32_t GLRenderer::CompileShader(uint32_t type, const char* src) {
-    uint32_t s = glCreateShader(type);
-    glShaderSource(s, 1, &src, nullptr);
-    glCompileShader(s);
+// Compile errors only surface once the link is queried, so the logs are read at that point.
+static void LogShaderErrors(uint32_t shader) {
     int ok = 0;
-    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
     if (!ok) {
-        char buf[1024]; glGetShaderInfoLog(s, sizeof(buf), nullptr, buf);
+        char buf[1024]; glGetShaderInfoLog(shader, sizeof(buf), nullptr, buf);
         std::cerr << "[GLRenderer] Shader compile error: " << buf << "\n";
-        glDeleteShader(s);
-        return 0;
     }
+}
+
+static uint32_t StartShader(uint32_t type, const char* src) {
+    uint32_t s = glCreateShader(type);
+    glShaderSource(s, 1, &src, nullptr);
+    glCompileShader(s);
     return s;
 }
 
-uint32_t GLRenderer::CreateProgram(const char* vs_src, const char* fs_src) {
-    uint32_t vs = CompileShader(GL_VERTEX_SHADER, vs_src);
-    uint32_t fs = CompileShader(GL_FRAGMENT_SHADER, fs_src);
-    if (!vs || !fs) return 0;
-    uint32_t p = glCreateProgram();
-    glAttachShader(p, vs);
-    glAttachShader(p, fs);
-    glLinkProgram(p);
-    int ok = 0;
-    glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char buf[1024]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
-        std::cerr << "[GLRenderer] Program link error: " << buf << "\n";
-        glDeleteProgram(p);
-        p = 0;
-    }
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-    if (p) std::cerr << "[GLRenderer] Linked program " << p << "\n";
-    LogGLErrorIfAny("CreateProgram");
+void GLRenderer::BeginProgram(PendingProgram& pp) {
+    pp.program = programCache_.Load(pp.vs_src, pp.fs_src);
+    if (pp.program) {
+        pp.from_cache = true;
+        return;
+    }
+    pp.vs = StartShader(GL_VERTEX_SHADER, pp.vs_src);
+    pp.fs = StartShader(GL_FRAGMENT_SHADER, pp.fs_src);
+    pp.program = glCreateProgram();
+    glAttachShader(pp.program, pp.vs);
+    glAttachShader(pp.program, pp.fs);
+    if (programCache_.Enabled()) glProgramParameteri(pp.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(pp.program);
+}
+
+uint32_t GLRenderer::FinishProgram(PendingProgram& pp) {
+    uint32_t p = pp.program;
+    if (!pp.from_cache) {
+        int ok = 0;
+        glGetProgramiv(p, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            LogShaderErrors(pp.vs);
+            LogShaderErrors(pp.fs);
+            char buf[1024]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
+            std::cerr << "[GLRenderer] Program link error: " << buf << "\n";
+            glDeleteProgram(p);
+            p = 0;
+        }
+        glDeleteShader(pp.vs);
+        glDeleteShader(pp.fs);
+        if (p) programCache_.Store(p, pp.vs_src, pp.fs_src);
+    }
+    if (p) {
+        // Attach whichever shared blocks the program uses to their fixed binding points. A
+        // program restored from a binary starts with default bindings too, so this runs for both.
+        GLuint frame = glGetUniformBlockIndex(p, "FrameConstants");
+        if (frame != GL_INVALID_INDEX) glUniformBlockBinding(p, frame, kFrameBlockBinding);
+        GLuint draw = glGetUniformBlockIndex(p, "DrawConstants");
+        if (draw != GL_INVALID_INDEX) glUniformBlockBinding(p, draw, kDrawBlockBinding);
+        std::cerr << "[GLRenderer] " << (pp.from_cache ? "Loaded cached" : "Linked") << " program " << p << "\n";
+    }
+    pp = PendingProgram{ pp.vs_src, pp.fs_src };
+    LogGLErrorIfAny("FinishProgram");
     return p;
 }
 
-MeshHandle GLRenderer::UploadMesh(const std::vector<float>& vertex_positions, const std::vector<uint32_t>& indices) {
-    MeshHandle h{};
+MeshBuffers GLRenderer::UploadMeshBuffers(std::span<const float> vertex_positions, std::span<const uint32_t> indices) {
+    MeshBuffers b{};
 
     if (vertex_positions.empty() || indices.empty()) {
-        std::cerr << "[GLRenderer] Warning: UploadMesh called with empty vertex or index data. verts=" 
+        std::cerr << "[GLRenderer] Warning: UploadMeshBuffers called with empty vertex or index data. verts=" 
                   << (vertex_positions.size()/3) << " indices=" << indices.size() << "\n";
     }
 
-    glGenVertexArrays(1, &h.vao);
-    glBindVertexArray(h.vao);
+    // Through GL_COPY_WRITE_BUFFER rather than GL_ELEMENT_ARRAY_BUFFER: that binding belongs to
+    // whatever VAO is bound, and this may run with a mesh VAO bound or on a context without one.
+    glGenBuffers(1, &b.vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, b.vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertex_positions.size_bytes(), vertex_positions.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &b.ebo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, b.ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, indices.size_bytes(), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    b.index_count = static_cast<uint32_t>(indices.size());
+    b.bytes = vertex_positions.size_bytes() + indices.size_bytes();
+    LogGLErrorIfAny("UploadMeshBuffers");
+    return b;
+}
 
-    glGenBuffers(1, &h.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, h.vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertex_positions.size() * sizeof(float), vertex_positions.data(), GL_STATIC_DRAW);
+void GLRenderer::DestroyMeshBuffers(MeshBuffers& b) {
+    if (b.ebo) glDeleteBuffers(1, &b.ebo);
+    if (b.vbo) glDeleteBuffers(1, &b.vbo);
+    b = MeshBuffers{};
+}
 
-    glGenBuffers(1, &h.ebo);
+MeshHandle GLRenderer::CreateMeshVAO(const MeshBuffers& b) {
+    MeshHandle h{};
+    if (!b.vbo || !b.ebo) return h;
+    h.vbo = b.vbo;
+    h.ebo = b.ebo;
+    h.index_count = b.index_count;
+
+    glGenVertexArrays(1, &h.vao);
+    BindVertexArray(h.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, h.vbo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, h.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
 
     // position only (vec3)
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
-    glBindVertexArray(0);
-    h.index_count = static_cast<uint32_t>(indices.size());
+    // per-instance model matrix (mat4 = 4 vec4 columns), read only by the instanced program
+    if (instanceVBO_) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO_);
+        for (GLuint c = 0; c < 4; ++c) {
+            glEnableVertexAttribArray(1 + c);
+            glVertexAttribPointer(1 + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(c * sizeof(glm::vec4)));
+            glVertexAttribDivisor(1 + c, 1);
+        }
+    }
 
+    BindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    LogGLErrorIfAny("UploadMesh");
+    LogGLErrorIfAny("CreateMeshVAO");
     return h;
 }
 
-void GLRenderer::RenderMesh(const MeshHandle& h, const glm::mat4& model, const glm::mat4& viewProj, const glm::vec3& color) {
-    // Log each render call to confirm draw invocation and primitive counts
-    if (!program_ || h.vao == 0) {
-        std::cerr << "[GLRenderer] RenderMesh skipped (program=" << program_ << " VAO=" << h.vao << ")\n";
-        return;
+void GLRenderer::UseProgram(uint32_t program) {
+    if (program == boundProgram_) return;
+    glUseProgram(program);
+    boundProgram_ = program;
+}
+
+void GLRenderer::BindVertexArray(uint32_t vao) {
+    if (vao == boundVAO_) return;
+    glBindVertexArray(vao);
+    boundVAO_ = vao;
+}
+
+void GLRenderer::ResetStateCache() {
+    boundProgram_ = ~0u;
+    boundVAO_ = ~0u;
+}
+
+void GLRenderer::PointInstanceAttributes(size_t first) {
+    const size_t base = first * sizeof(glm::mat4);
+    for (GLuint c = 0; c < 4; ++c) {
+        glVertexAttribPointer(1 + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(base + c * sizeof(glm::vec4)));
     }
+}
 
-    glUseProgram(program_);
-    GLint loc = glGetUniformLocation(program_, "uMVP");
-    if (loc >= 0) {
-        glm::mat4 mvp = viewProj * model;
-        glUniformMatrix4fv(loc, 1, GL_FALSE, &mvp[0][0]);
+void GLRenderer::SetFrameConstants(const glm::mat4& view, const glm::mat4& proj) {
+    FrameConstants fc;
+    fc.view = view;
+    fc.proj = proj;
+    fc.view_proj = proj * view;
+    // remove translation from view so the skybox stays centered on the camera
+    glm::mat4 viewNoTrans = view;
+    viewNoTrans[3] = glm::vec4(0.0f, 0.0f, 0.0f, viewNoTrans[3].w);
+    fc.sky_view_proj = proj * viewNoTrans;
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), &fc, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+size_t GLRenderer::WriteDrawConstants(std::span<const DrawConstants> blocks) {
+    const size_t bytes = blocks.size() * drawStride_;
+    glBindBuffer(GL_UNIFORM_BUFFER, drawUBO_);
+    if (bytes > drawRingSize_) {
+        drawRingSize_ = std::max(bytes, drawRingSize_ * 2);
+        glBufferData(GL_UNIFORM_BUFFER, drawRingSize_, nullptr, GL_STREAM_DRAW);
+        drawRingHead_ = 0;
+    } else if (drawRingHead_ + bytes > drawRingSize_) {
+        // Wrap: orphan the storage so draws still reading the old blocks keep their copy.
+        glBufferData(GL_UNIFORM_BUFFER, drawRingSize_, nullptr, GL_STREAM_DRAW);
+        drawRingHead_ = 0;
+    }
+    const size_t offset = drawRingHead_;
+    // Nothing since the last orphan reads this range, so the write needs no synchronization.
+    auto* dst = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, offset, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    if (dst) {
+        for (size_t k = 0; k < blocks.size(); ++k) std::memcpy(dst + k * drawStride_, &blocks[k], sizeof(DrawConstants));
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else {
+        for (size_t k = 0; k < blocks.size(); ++k) {
+            glBufferSubData(GL_UNIFORM_BUFFER, offset + k * drawStride_, sizeof(DrawConstants), &blocks[k]);
+        }
     }
-    GLint locc = glGetUniformLocation(program_, "uColor");
-    if (locc >= 0) glUniform3fv(locc, 1, &color[0]);
-    glBindVertexArray(h.vao);
-    glDrawElements(GL_TRIANGLES, (GLsizei)h.index_count, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-    LogGLErrorIfAny("RenderMesh");
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    drawRingHead_ += bytes;
+    return offset;
 }
 
-void GLRenderer::RenderPlane(const glm::mat4& viewProj, const glm::vec3& color) {
-    if (!program_ || !planeVAO_ || planeIndexCount_ == 0) return;
+void GLRenderer::BindDrawConstants(size_t offset) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, kDrawBlockBinding, drawUBO_, offset, sizeof(DrawConstants));
+}
 
-    glUseProgram(program_);
-    GLint loc = glGetUniformLocation(program_, "uMVP");
-    if (loc >= 0) {
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::mat4 mvp = viewProj * model;
-        glUniformMatrix4fv(loc, 1, GL_FALSE, &mvp[0][0]);
+void GLRenderer::Execute(const RenderQueue& queue, const glm::mat4& view, const glm::mat4& proj) {
+    ResetStateCache();
+    SetFrameConstants(view, proj);
+    std::span<const DrawPacket> packets = queue.Packets();
+    const std::vector<glm::mat4>& matrices = queue.Matrices();
+    const bool instanced = instancedProgram_ && instanceVBO_;
+
+    // All model matrices of the frame in one upload; the buffer grows but never shrinks.
+    // Runs address their slice by re-pointing the VAO's instance attributes.
+    if (!matrices.empty() && instanced) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO_);
+        if (matrices.size() > instanceCapacity_) instanceCapacity_ = std::max(matrices.size(), instanceCapacity_ * 2);
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity_ * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, matrices.size() * sizeof(glm::mat4), matrices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Split the packets into draws (a mesh run is one draw when instancing) and write every
+    // draw's constants into the ring with one mapping.
+    runs_.clear();
+    drawScratch_.clear();
+    for (size_t i = 0; i < packets.size();) {
+        const DrawPacket& p = packets[i];
+        size_t end = i + 1;
+        if (p.program == RenderProgram::Mesh && instanced) {
+            while (end < packets.size() && packets[end].program == RenderProgram::Mesh &&
+                   packets[end].mesh.vao == p.mesh.vao && packets[end].color == p.color &&
+                   packets[end].matrix == packets[end - 1].matrix + 1) {
+                ++end;
+            }
+        }
+        if (p.program != RenderProgram::Skybox) {
+            glm::mat4 model = p.program == RenderProgram::Mesh && !instanced ? matrices[p.matrix] : glm::mat4(1.0f);
+            drawScratch_.push_back({ model, glm::vec4(p.color, 1.0f) });
+        }
+        runs_.push_back({ static_cast<uint32_t>(i), static_cast<uint32_t>(end) });
+        i = end;
+    }
+    const size_t first_block = drawScratch_.empty() ? 0 : WriteDrawConstants(drawScratch_);
+
+    size_t block = 0;
+    for (const DrawRun& run : runs_) {
+        const DrawPacket& p = packets[run.begin];
+        switch (p.program) {
+        case RenderProgram::Mesh:
+            BindDrawConstants(first_block + block++ * drawStride_);
+            if (instanced) {
+                UseProgram(instancedProgram_);
+                BindVertexArray(p.mesh.vao);
+                glBindBuffer(GL_ARRAY_BUFFER, instanceVBO_);
+                PointInstanceAttributes(p.matrix);
+                glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)p.mesh.index_count, GL_UNSIGNED_INT, 0, (GLsizei)(run.end - run.begin));
+            } else {
+                UseProgram(program_);
+                BindVertexArray(p.mesh.vao);
+                glDrawElements(GL_TRIANGLES, (GLsizei)p.mesh.index_count, GL_UNSIGNED_INT, 0);
+            }
+            break;
+        case RenderProgram::Flat:
+            BindDrawConstants(first_block + block++ * drawStride_);
+            DrawPlane();
+            break;
+        case RenderProgram::Skybox:
+            RenderSkybox();
+            break;
+        }
     }
-    GLint locc = glGetUniformLocation(program_, "uColor");
-    if (locc >= 0) glUniform3fv(locc, 1, &color[0]);
 
-    glBindVertexArray(planeVAO_);
+    // Leave no VAO bound, so later GL_ELEMENT_ARRAY_BUFFER binds can't modify a mesh.
+    BindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    LogGLErrorIfAny("Execute");
+}
+
+void GLRenderer::DrawPlane() {
+    if (!program_ || !planeVAO_ || planeIndexCount_ == 0) return;
+
+    UseProgram(program_);
+    BindVertexArray(planeVAO_);
     glDrawElements(GL_TRIANGLES, (GLsizei)planeIndexCount_, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 
-    LogGLErrorIfAny("RenderPlane");
+    LogGLErrorIfAny("DrawPlane");
 }
 
 void GLRenderer::DestroyMesh(MeshHandle& h) {
     if (h.ebo) { glDeleteBuffers(1, &h.ebo); std::cerr << "[GLRenderer] Deleted EBO " << h.ebo << "\n"; h.ebo = 0; }
     if (h.vbo) { glDeleteBuffers(1, &h.vbo); std::cerr << "[GLRenderer] Deleted VBO " << h.vbo << "\n"; h.vbo = 0; }
+    if (h.vao && h.vao == boundVAO_) boundVAO_ = 0; // deleting the bound VAO unbinds it
     if (h.vao) { glDeleteVertexArrays(1, &h.vao); std::cerr << "[GLRenderer] Deleted VAO " << h.vao << "\n"; h.vao = 0; }
     h.index_count = 0;
     LogGLErrorIfAny("DestroyMesh");
@@ -420,42 +683,28 @@ bool GLRenderer::LoadSkybox(const std::string& folder_path) {
     return true;
 }
 
-void GLRenderer::RenderSkybox(const glm::mat4& view, const glm::mat4& proj) {
+void GLRenderer::RenderSkybox() {
     if (!cubemapTex_ || !skyboxProgram_ || !skyboxVAO_) return;
 
     // Save state we change
     GLboolean depthMask;
     glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
     GLint prevDepthFunc; glGetIntegerv(GL_DEPTH_FUNC, &prevDepthFunc);
-    GLint prevProg; glGetIntegerv(GL_CURRENT_PROGRAM, &prevProg);
 
     // Render skybox:
     glDepthFunc(GL_LEQUAL);
     glDepthMask(GL_FALSE);
 
-    glUseProgram(skyboxProgram_);
-    // remove translation from view
-    glm::mat4 viewNoTrans = view;
-    viewNoTrans[3] = glm::vec4(0.0f, 0.0f, 0.0f, viewNoTrans[3].w);
-
-    GLint locView = glGetUniformLocation(skyboxProgram_, "uView");
-    if (locView >= 0) glUniformMatrix4fv(locView, 1, GL_FALSE, &viewNoTrans[0][0]);
-    GLint locProj = glGetUniformLocation(skyboxProgram_, "uProj");
-    if (locProj >= 0) glUniformMatrix4fv(locProj, 1, GL_FALSE, &proj[0][0]);
-
+    UseProgram(skyboxProgram_);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex_);
-    GLint locSampler = glGetUniformLocation(skyboxProgram_, "skybox");
-    if (locSampler >= 0) glUniform1i(locSampler, 0);
 
-    glBindVertexArray(skyboxVAO_);
+    BindVertexArray(skyboxVAO_);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
 
     // restore state
     glDepthMask(depthMask);
     glDepthFunc(prevDepthFunc);
-    glUseProgram(prevProg);
 
     LogGLErrorIfAny("RenderSkybox");
 }
\ No newline at end of file
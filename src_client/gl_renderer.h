@@ -1,10 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <span>
 #include <cstdint>
 #include <functional>
 #include <mutex>
+#include <string>
 #include <glm/glm.hpp>
+#include "program_cache.h"
 
 // Simple mesh handle
 struct MeshHandle {
@@ -14,22 +17,42 @@ struct MeshHandle {
     uint32_t index_count = 0;
 };
 
+// A mesh's vertex and index buffers without a VAO. Buffer objects are shared by every context in
+// the share group, so any of them can create these; VAOs are not, so the render context turns
+// them into a MeshHandle with CreateMeshVAO.
+struct MeshBuffers {
+    uint32_t vbo = 0;
+    uint32_t ebo = 0;
+    uint32_t index_count = 0;
+    uint64_t bytes = 0;
+};
+
+class RenderQueue;
+
 class GLRenderer {
 public:
     GLRenderer();
     ~GLRenderer();
 
-    // Call from main thread after GL context is current
-    void Init();
+    // Call from main thread after GL context is current. Linked programs are cached in
+    // shader_cache_dir (empty = always compile from source).
+    void Init(const std::string& shader_cache_dir = std::string());
 
-    // Upload CPU vertex/index buffers on main thread. Returns handle.
-    MeshHandle UploadMesh(const std::vector<float>& vertex_positions, const std::vector<uint32_t>& indices);
+    // Uploading a mesh is two steps. UploadMeshBuffers and DestroyMeshBuffers only touch buffer
+    // objects and may run on any context sharing with the main one (see GLUploadThread);
+    // CreateMeshVAO must run on the main thread, after the buffers' upload has completed.
+    static MeshBuffers UploadMeshBuffers(std::span<const float> vertex_positions, std::span<const uint32_t> indices);
+    static void DestroyMeshBuffers(MeshBuffers& b);
+    MeshHandle CreateMeshVAO(const MeshBuffers& b);
 
-    // Render a mesh with a given model matrix and viewProj matrix and color
-    void RenderMesh(const MeshHandle& h, const glm::mat4& model, const glm::mat4& viewProj, const glm::vec3& color);
+    // Draw a sorted RenderQueue: every model matrix is uploaded in one buffer update, every draw's
+    // constants in one ring write, runs of one mesh become one instanced draw, and programs/VAOs
+    // are only rebound when they change.
+    void Execute(const RenderQueue& queue, const glm::mat4& view, const glm::mat4& proj);
 
-    // Render a simple ground plane (large quad) beneath models. Call after Init and before rendering models.
-    void RenderPlane(const glm::mat4& viewProj, const glm::vec3& color = glm::vec3(0.35f, 0.35f, 0.35f));
+    // The renderer skips glUseProgram/glBindVertexArray calls that wouldn't change anything.
+    // Call after other code (e.g. ImGui) touched that state; Execute does so on entry.
+    void ResetStateCache();
 
     // Destroy mesh resources (must be called on main thread)
     void DestroyMesh(MeshHandle& h);
@@ -40,16 +63,76 @@ public:
     // Returns true on success.
     bool LoadSkybox(const std::string& folder_path);
 
-    // Render the skybox. Provide view and projection matrices. view must be the camera view matrix
-    // (the function removes translation so the skybox stays centered on the camera).
-    void RenderSkybox(const glm::mat4& view, const glm::mat4& proj);
-
 private:
-    uint32_t CompileShader(uint32_t type, const char* src);
-    uint32_t CreateProgram(const char* vs_src, const char* fs_src);
+    // std140 mirrors of the shader blocks.
+    struct FrameConstants {
+        glm::mat4 view;
+        glm::mat4 proj;
+        glm::mat4 view_proj;
+        glm::mat4 sky_view_proj;
+    };
+    struct DrawConstants {
+        glm::mat4 model;
+        glm::vec4 color;
+    };
+    static_assert(sizeof(FrameConstants) == 256 && sizeof(DrawConstants) == 80, "std140 layout");
+    struct DrawRun {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // A program being restored from the binary cache or compiled and linked by the driver.
+    struct PendingProgram {
+        const char* vs_src;
+        const char* fs_src;
+        uint32_t program = 0;
+        uint32_t vs = 0;
+        uint32_t fs = 0;
+        bool from_cache = false;
+    };
+    // Starts the work without waiting for it; FinishProgram waits, reports errors, caches the
+    // binary of a freshly linked program and returns it (0 on failure).
+    void BeginProgram(PendingProgram& pp);
+    uint32_t FinishProgram(PendingProgram& pp);
+
+    void UseProgram(uint32_t program);
+    void BindVertexArray(uint32_t vao);
+    // Point the bound VAO's instance attributes at matrix `first` of instanceVBO_.
+    void PointInstanceAttributes(size_t first);
+    // Copies blocks into the draw ring (orphaning it on wrap) and returns the first one's offset;
+    // block k is at offset + k * drawStride_.
+    size_t WriteDrawConstants(std::span<const DrawConstants> blocks);
+    void BindDrawConstants(size_t offset);
+    // Camera matrices in the FrameConstants uniform block every program shares.
+    void SetFrameConstants(const glm::mat4& view, const glm::mat4& proj);
+    void DrawPlane();
+    // Drawn with sky_view_proj (no camera translation), so it stays centered on the camera.
+    void RenderSkybox();
 
+    // Last state bound through UseProgram/BindVertexArray; ~0u = unknown.
+    uint32_t boundProgram_ = ~0u;
+    uint32_t boundVAO_ = ~0u;
+
+    ProgramBinaryCache programCache_{ std::string() };
     uint32_t program_ = 0;
 
+    // Instancing: per-instance model matrices at attributes 1..4 of every mesh VAO, streamed
+    // through one shared buffer that is orphaned before each batch.
+    uint32_t instancedProgram_ = 0;
+    uint32_t instanceVBO_ = 0;
+    static constexpr size_t kInitialInstanceCapacity = 1024;
+    size_t instanceCapacity_ = 0; // matrices
+
+    // Uniform buffers: FrameConstants (one block) and a ring of DrawConstants blocks.
+    static constexpr size_t kDrawRingBlocks = 1024;
+    uint32_t frameUBO_ = 0;
+    uint32_t drawUBO_ = 0;
+    size_t drawStride_ = 256;
+    size_t drawRingSize_ = 0;
+    size_t drawRingHead_ = 0;
+    std::vector<DrawConstants> drawScratch_;
+    std::vector<DrawRun> runs_;
+
     // Skybox resources
     uint32_t skyboxProgram_ = 0;
     uint32_t skyboxVAO_ = 0;
@@ -0,0 +1,136 @@
+#include "gl_upload_thread.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+// How long the thread blocks on the oldest fence when it has nothing new to upload.
+static constexpr uint64_t kFenceWaitNs = 2'000'000;
+// Bound on waiting for uploads still on the GPU when stopping.
+static constexpr uint64_t kStopFenceWaitNs = 1'000'000'000;
+
+GLUploadThread::~GLUploadThread() {
+    Stop();
+}
+
+bool GLUploadThread::Start() {
+    if (running_) return true;
+    // Same context version as the main window (the hints are still set), but never shown.
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context_ = glfwCreateWindow(1, 1, "P4 upload context", nullptr, main_window_);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!context_) {
+        std::cerr << "[GLUploadThread] Can't create a shared context; uploading on the main thread\n";
+        return false;
+    }
+    {
+        std::scoped_lock lk(mtx_);
+        stop_ = false;
+    }
+    running_ = true;
+    thread_ = std::thread([this]() { Run(); });
+    std::cerr << "[GLUploadThread] Started\n";
+    return true;
+}
+
+void GLUploadThread::Stop() {
+    {
+        std::scoped_lock lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    running_ = false;
+
+    // Anything submitted after the thread's final sweep.
+    std::deque<Job> jobs;
+    {
+        std::scoped_lock lk(mtx_);
+        jobs.swap(jobs_);
+    }
+    for (Job& job : jobs) job.done(false, MeshBuffers{});
+
+    if (context_) {
+        glfwDestroyWindow(context_);
+        context_ = nullptr;
+        std::cerr << "[GLUploadThread] Stopped\n";
+    }
+}
+
+void GLUploadThread::Submit(MeshData mesh, DoneCallback done) {
+    {
+        std::scoped_lock lk(mtx_);
+        if (!stop_ && running_) {
+            jobs_.push_back(Job{ std::move(mesh), std::move(done) });
+            cv_.notify_one();
+            return;
+        }
+    }
+    done(false, MeshBuffers{});
+}
+
+void GLUploadThread::Run() {
+    glfwMakeContextCurrent(context_);
+    while (true) {
+        Job job;
+        bool have_job = false;
+        {
+            std::unique_lock lk(mtx_);
+            // With uploads in flight, don't sleep on the queue: their fences need polling.
+            if (in_flight_.empty()) cv_.wait(lk, [&]() { return stop_ || !jobs_.empty(); });
+            if (stop_) break;
+            if (!jobs_.empty()) {
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+                have_job = true;
+            }
+        }
+        if (have_job) {
+            InFlight f;
+            f.buffers = GLRenderer::UploadMeshBuffers(job.mesh.positions, job.mesh.indices);
+            f.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            // Without a flush the fence might never reach the GPU and waits on it could hang.
+            glFlush();
+            f.done = std::move(job.done);
+            in_flight_.push_back(std::move(f));
+            job.mesh = MeshData(); // release the CPU copy now rather than at the next job
+        }
+        // Keep uploading while there's work; only block on the GPU when idle.
+        CompleteSignaled(have_job ? 0 : kFenceWaitNs);
+    }
+
+    // Stopping: uploads already issued finish normally, queued ones fail.
+    while (!in_flight_.empty()) {
+        InFlight& f = in_flight_.front();
+        GLenum r = glClientWaitSync(static_cast<GLsync>(f.fence), GL_SYNC_FLUSH_COMMANDS_BIT, kStopFenceWaitNs);
+        glDeleteSync(static_cast<GLsync>(f.fence));
+        bool ok = (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED);
+        if (!ok) GLRenderer::DestroyMeshBuffers(f.buffers);
+        f.done(ok, f.buffers);
+        in_flight_.pop_front();
+    }
+    std::deque<Job> jobs;
+    {
+        std::scoped_lock lk(mtx_);
+        jobs.swap(jobs_);
+    }
+    for (Job& job : jobs) job.done(false, MeshBuffers{});
+    glfwMakeContextCurrent(nullptr);
+}
+
+void GLUploadThread::CompleteSignaled(uint64_t timeout_ns) {
+    while (!in_flight_.empty()) {
+        InFlight& f = in_flight_.front();
+        GLenum r = glClientWaitSync(static_cast<GLsync>(f.fence), 0, timeout_ns);
+        if (r == GL_TIMEOUT_EXPIRED) return;
+        glDeleteSync(static_cast<GLsync>(f.fence));
+        if (r == GL_WAIT_FAILED) {
+            std::cerr << "[GLUploadThread] Fence wait failed\n";
+            GLRenderer::DestroyMeshBuffers(f.buffers);
+            f.done(false, MeshBuffers{});
+        } else {
+            f.done(true, f.buffers);
+        }
+        in_flight_.pop_front();
+        timeout_ns = 0; // only ever block for the first one
+    }
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "gl_renderer.h"
+#include "load_task.h"
+#include "model_loader.h"
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+struct GLFWwindow;
+
+// Optional thread that copies mesh data into GL buffers on its own context, so uploads never take
+// time from a frame. The context belongs to a hidden window sharing objects with the main one.
+// Each upload is fenced; its MeshBuffers are handed out only once the GPU has finished the copy,
+// and the main thread then only has to create the VAO (GLRenderer::CreateMeshVAO).
+class GLUploadThread {
+public:
+    // ok=false if the thread stopped before the upload ran (or its fence never signaled).
+    using DoneCallback = std::function<void(bool ok, MeshBuffers buffers)>;
+
+    // Main thread (GLFW creates windows only there). Does nothing until Start.
+    explicit GLUploadThread(GLFWwindow* main_window) : main_window_(main_window) {}
+    ~GLUploadThread();
+
+    // Main thread. Creates the shared context and starts the thread; false if the context
+    // couldn't be created (uploads then stay on the main thread).
+    bool Start();
+    // Main thread. Uploads already on the GPU still complete; queued ones fail. Joins the thread
+    // and destroys the context.
+    void Stop();
+    bool Running() const { return running_.load(); }
+
+    // Any thread. done runs on the upload thread, so it must be cheap.
+    void Submit(MeshData mesh, DoneCallback done);
+
+    struct Result {
+        bool ok = false;
+        MeshBuffers buffers;
+    };
+    // co_await Upload(mesh, ex): uploads on this thread and resumes the awaiting coroutine on ex.
+    class UploadAwaiter {
+    public:
+        UploadAwaiter(GLUploadThread* thread, MeshData mesh, ResumeExecutor* resume_on)
+            : thread_(thread), mesh_(std::move(mesh)), resume_on_(resume_on) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            thread_->Submit(std::move(mesh_), [this, h](bool ok, MeshBuffers buffers) {
+                result_.ok = ok;
+                result_.buffers = buffers;
+                resume_on_->Post(h);
+            });
+        }
+        Result await_resume() { return result_; }
+
+    private:
+        GLUploadThread* thread_;
+        MeshData mesh_;
+        ResumeExecutor* resume_on_;
+        Result result_;
+    };
+    UploadAwaiter Upload(MeshData mesh, ResumeExecutor* resume_on) { return UploadAwaiter(this, std::move(mesh), resume_on); }
+
+private:
+    struct Job {
+        MeshData mesh;
+        DoneCallback done;
+    };
+    struct InFlight {
+        MeshBuffers buffers;
+        void* fence = nullptr; // GLsync
+        DoneCallback done;
+    };
+
+    void Run();
+    // Completes uploads whose fences have signaled, oldest first; waits up to timeout_ns for the
+    // oldest one.
+    void CompleteSignaled(uint64_t timeout_ns);
+
+    GLFWwindow* main_window_;
+    GLFWwindow* context_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{ false };
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    bool stop_ = false;
+
+    std::deque<InFlight> in_flight_; // upload thread only
+};
\ No newline at end of file
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+// Minimal C++20 coroutine toolkit used by SceneLoader.
+// Task<T> is lazily started and resumes its awaiter when done; DetachedTask is a fire-and-forget root.
+// Thread hops are explicit: co_await ResumeOn(executor) continues on one of that executor's threads.
+
+// Anything that can resume a suspended coroutine later (worker pool, main thread, ...).
+class ResumeExecutor {
+public:
+    virtual ~ResumeExecutor() = default;
+    virtual void Post(std::coroutine_handle<> h) = 0;
+};
+
+// co_await ResumeOn(ex): suspend and continue on ex.
+struct ResumeOn {
+    ResumeExecutor& ex;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const { ex.Post(h); }
+    void await_resume() const noexcept {}
+};
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    // Symmetric transfer back to whoever awaited the task.
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept { return h.promise().continuation; }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+    void return_value(T v) { value = std::move(v); }
+    T Take() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    void return_void() noexcept {}
+    void Take() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+} // namespace detail
+
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : detail::TaskPromise<T> {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    Task(Task&& o) noexcept : handle_(std::exchange(o.handle_, {})) {}
+    Task& operator=(Task&& o) noexcept {
+        if (this != &o) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(o.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (handle_) handle_.destroy(); }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().Take(); }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Fire-and-forget root coroutine: starts eagerly and frees its own frame when it finishes.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept {
+            try { throw; }
+            catch (const std::exception& ex) { std::cerr << "[LoadTask] Unhandled exception in detached task: " << ex.what() << "\n"; }
+            catch (...) { std::cerr << "[LoadTask] Unknown exception in detached task\n"; }
+        }
+    };
+};
+
+// Runs all tasks concurrently and resumes the awaiter (on whichever thread finished last)
+// with the number of tasks that returned true.
+class WhenAll {
+public:
+    explicit WhenAll(std::vector<Task<bool>> tasks) : tasks_(std::move(tasks)) {}
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+    bool await_suspend(std::coroutine_handle<> parent) {
+        parent_ = parent;
+        remaining_.store(tasks_.size() + 1);
+        for (auto& t : tasks_) Run(this, t);
+        // Drop our own guard count; if every task already finished inline, don't suspend at all.
+        return remaining_.fetch_sub(1) != 1;
+    }
+    size_t await_resume() const noexcept { return succeeded_.load(); }
+
+private:
+    static DetachedTask Run(WhenAll* self, Task<bool>& task) {
+        bool ok = false;
+        try { ok = co_await task; }
+        catch (const std::exception& ex) { std::cerr << "[LoadTask] Task failed with exception: " << ex.what() << "\n"; }
+        if (ok) self->succeeded_.fetch_add(1);
+        if (self->remaining_.fetch_sub(1) == 1) self->parent_.resume();
+    }
+
+    std::vector<Task<bool>> tasks_;
+    std::coroutine_handle<> parent_;
+    std::atomic<size_t> remaining_{ 0 };
+    std::atomic<size_t> succeeded_{ 0 };
+};
+
+// Counting semaphore for coroutines. Acquire() suspends until a slot frees up and yields false
+// if the semaphore was closed while waiting. Release() hands the slot directly to the oldest waiter.
+// The limit can be changed at runtime (adaptive concurrency); lowering it lets current holders finish.
+class AsyncSemaphore {
+public:
+    explicit AsyncSemaphore(size_t limit) : limit_(limit) {}
+
+    class Acquirer {
+    public:
+        Acquirer(AsyncSemaphore& sem, ResumeExecutor* resume_on) : sem_(sem), resume_on_(resume_on) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::scoped_lock lk(sem_.mtx_);
+            if (sem_.closed_) return false;
+            if (sem_.in_use_ < sem_.limit_ && sem_.waiters_.empty()) {
+                ++sem_.in_use_;
+                acquired_ = true;
+                return false;
+            }
+            handle_ = h;
+            sem_.waiters_.push_back(this);
+            return true;
+        }
+        bool await_resume() const noexcept { return acquired_; }
+
+    private:
+        friend class AsyncSemaphore;
+        void Wake() {
+            if (resume_on_) resume_on_->Post(handle_);
+            else handle_.resume();
+        }
+
+        AsyncSemaphore& sem_;
+        ResumeExecutor* resume_on_;
+        std::coroutine_handle<> handle_;
+        bool acquired_ = false;
+    };
+
+    // resume_on: executor a waiter is resumed on once it gets a slot. Null resumes it inline on the
+    // releasing thread, which is only appropriate if the waiter suspends again quickly.
+    Acquirer Acquire(ResumeExecutor* resume_on = nullptr) { return Acquirer(*this, resume_on); }
+
+    void Release() {
+        std::deque<Acquirer*> granted;
+        {
+            std::scoped_lock lk(mtx_);
+            --in_use_;
+            if (!closed_) GrantLocked(granted);
+        }
+        for (auto* w : granted) w->Wake();
+    }
+
+    void SetLimit(size_t limit) {
+        std::deque<Acquirer*> granted;
+        {
+            std::scoped_lock lk(mtx_);
+            limit_ = limit == 0 ? 1 : limit;
+            if (!closed_) GrantLocked(granted);
+        }
+        for (auto* w : granted) w->Wake();
+    }
+
+    size_t Limit() const {
+        std::scoped_lock lk(mtx_);
+        return limit_;
+    }
+
+    // Fail all current and future waiters (used on shutdown).
+    void Close() {
+        std::deque<Acquirer*> waiters;
+        {
+            std::scoped_lock lk(mtx_);
+            closed_ = true;
+            waiters.swap(waiters_);
+        }
+        for (auto* w : waiters) w->Wake();
+    }
+
+private:
+    // Move waiters that now fit under the limit into `out` (woken by the caller, outside the lock).
+    void GrantLocked(std::deque<Acquirer*>& out) {
+        while (!waiters_.empty() && in_use_ < limit_) {
+            Acquirer* next = waiters_.front();
+            waiters_.pop_front();
+            next->acquired_ = true;
+            ++in_use_;
+            out.push_back(next);
+        }
+    }
+
+    mutable std::mutex mtx_;
+    size_t limit_;
+    size_t in_use_ = 0;
+    bool closed_ = false;
+    std::deque<Acquirer*> waiters_;
+};
+
+// co_await WriteFileOn(ex, path, data): hop to ex and perform the blocking write there
+// (parent directories are created as needed). Yields true on success.
+// The data goes to a temp file named after the writing thread and is renamed into place, so
+// readers never see a partial file and two loads writing the same path don't interleave.
+// `data` must stay alive until the await completes.
+struct WriteFileOn {
+    ResumeExecutor& ex;
+    std::string path;
+    const std::string& data;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const { ex.Post(h); }
+    bool await_resume() const {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        const std::string tmp = path + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+            if (ofs) ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!ofs) {
+                ofs.close();
+                std::filesystem::remove(tmp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+};
\ No newline at end of file
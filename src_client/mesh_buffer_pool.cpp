@@ -0,0 +1,35 @@
+#include "mesh_buffer_pool.h"
+
+// Arrays up to 4 MiB (about 350k vertices) come from pools; libstdc++ won't pool larger blocks
+// anyway, and those go straight to the heap and back.
+MeshBufferPool::MeshBufferPool() : pool_(std::pmr::pool_options{ 0, size_t(4) << 20 }) {}
+
+MeshBufferPool& MeshBufferPool::Instance() {
+    static MeshBufferPool pool;
+    return pool;
+}
+
+bool MeshBufferPool::TrimIfUnused() {
+    std::scoped_lock lk(mtx_);
+    if (live_ != 0) return false;
+    pool_.release();
+    return true;
+}
+
+size_t MeshBufferPool::LiveAllocations() const {
+    std::scoped_lock lk(mtx_);
+    return live_;
+}
+
+void* MeshBufferPool::do_allocate(size_t bytes, size_t alignment) {
+    std::scoped_lock lk(mtx_);
+    void* p = pool_.allocate(bytes, alignment);
+    ++live_;
+    return p;
+}
+
+void MeshBufferPool::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    std::scoped_lock lk(mtx_);
+    pool_.deallocate(p, bytes, alignment);
+    --live_;
+}
\ No newline at end of file
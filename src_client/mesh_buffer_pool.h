@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+// Size-class pool for the loader's mesh buffers. Freed buffers go back to their pool and are reused
+// by the next model of similar size instead of returning to the general heap, which keeps long
+// sessions (thousands of models) from fragmenting. Pools never shrink on their own, so the loader
+// calls TrimIfUnused whenever it goes idle to hand the peak of a burst back to the heap.
+// Thread-safe.
+class MeshBufferPool final : public std::pmr::memory_resource {
+public:
+    static MeshBufferPool& Instance();
+
+    // Releases every pooled block if no buffer from the pool is alive; false otherwise.
+    bool TrimIfUnused();
+    size_t LiveAllocations() const;
+
+private:
+    MeshBufferPool();
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    mutable std::mutex mtx_; // guards pool_ and live_ together so a trim can't race an allocation
+    std::pmr::unsynchronized_pool_resource pool_;
+    size_t live_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "mesh_registry.h"
+#include <iostream>
+
+bool MeshRegistry::Contains(const std::string& key) const {
+    if (key.empty()) return false;
+    std::scoped_lock lk(mtx_);
+    return entries_.count(key) != 0;
+}
+
+MeshHandle MeshRegistry::Acquire(const std::string& key, MeshStats* stats) {
+    if (key.empty()) return MeshHandle{};
+    std::scoped_lock lk(mtx_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return MeshHandle{};
+    ++it->second.refs;
+    ++refs_;
+    if (stats) *stats = it->second.stats;
+    return it->second.handle;
+}
+
+MeshHandle MeshRegistry::Upload(const std::string& key, const MeshData& mesh, const MeshStats& stats) {
+    // Another scene may have uploaded the same content while this one was parsing.
+    MeshHandle shared = Acquire(key);
+    if (shared.vao) return shared;
+    MeshBuffers buffers = GLRenderer::UploadMeshBuffers(mesh.positions, mesh.indices);
+    uint64_t bytes = buffers.bytes;
+    return Insert(key, renderer_->CreateMeshVAO(buffers), stats, bytes);
+}
+
+MeshHandle MeshRegistry::Adopt(const std::string& key, MeshBuffers buffers, const MeshStats& stats) {
+    MeshHandle shared = Acquire(key);
+    if (shared.vao) {
+        GLRenderer::DestroyMeshBuffers(buffers);
+        return shared;
+    }
+    uint64_t bytes = buffers.bytes;
+    return Insert(key, renderer_->CreateMeshVAO(buffers), stats, bytes);
+}
+
+void MeshRegistry::Discard(MeshBuffers& buffers) {
+    GLRenderer::DestroyMeshBuffers(buffers);
+}
+
+MeshHandle MeshRegistry::Insert(const std::string& key, const MeshHandle& handle, const MeshStats& stats, uint64_t bytes) {
+    if (!handle.vao) return handle;
+    Entry e;
+    e.handle = handle;
+    e.stats = stats;
+    e.refs = 1;
+    e.bytes = bytes;
+
+    std::scoped_lock lk(mtx_);
+    // Unshared meshes still get a unique entry, so Release treats both kinds the same way.
+    std::string entry_key = key.empty() ? "#unshared-" + std::to_string(++unshared_counter_) : key;
+    key_by_vao_[e.handle.vao] = entry_key;
+    ++refs_;
+    bytes_ += e.bytes;
+    entries_.emplace(std::move(entry_key), std::move(e));
+    return handle;
+}
+
+void MeshRegistry::Release(MeshHandle& h) {
+    if (!h.vao) return;
+    MeshHandle to_destroy{};
+    {
+        std::scoped_lock lk(mtx_);
+        auto k = key_by_vao_.find(h.vao);
+        if (k == key_by_vao_.end()) {
+            std::cerr << "[MeshRegistry] Release of unknown VAO " << h.vao << "\n";
+            h = MeshHandle{};
+            return;
+        }
+        auto it = entries_.find(k->second);
+        --refs_;
+        if (--it->second.refs == 0) {
+            to_destroy = it->second.handle;
+            bytes_ -= it->second.bytes;
+            entries_.erase(it);
+            key_by_vao_.erase(k);
+        }
+    }
+    if (to_destroy.vao) renderer_->DestroyMesh(to_destroy);
+    h = MeshHandle{};
+}
+
+void MeshRegistry::DestroyAll() {
+    std::unordered_map<std::string, Entry> entries;
+    {
+        std::scoped_lock lk(mtx_);
+        entries.swap(entries_);
+        key_by_vao_.clear();
+        refs_ = 0;
+        bytes_ = 0;
+    }
+    for (auto& [key, e] : entries) renderer_->DestroyMesh(e.handle);
+}
+
+size_t MeshRegistry::MeshCount() const {
+    std::scoped_lock lk(mtx_);
+    return entries_.size();
+}
+
+size_t MeshRegistry::ReferenceCount() const {
+    std::scoped_lock lk(mtx_);
+    return refs_;
+}
+
+uint64_t MeshRegistry::ResidentBytes() const {
+    std::scoped_lock lk(mtx_);
+    return bytes_;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "gl_renderer.h"
+#include "model_loader.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// GPU meshes shared by content hash. A model that appears in several scenes (the same prop in
+// every scene, a scene loaded twice) is uploaded once; every SceneDescriptor holding its handle
+// owns one reference, and the mesh is destroyed when the last one is released. Sharing a VAO is
+// also what lets the renderer draw repeated models with one instanced call.
+//
+// GL work (Upload, Release, DestroyAll) happens on the thread that owns the context; Contains may be
+// called from any thread as a hint that Acquire will probably succeed.
+class MeshRegistry {
+public:
+    explicit MeshRegistry(GLRenderer* renderer) : renderer_(renderer) {}
+
+    // ---- any thread ----
+    bool Contains(const std::string& key) const;
+
+    // ---- GL thread ----
+    // Another reference to a resident mesh (and its stats, if `stats` is non-null); an empty
+    // handle if the key isn't resident.
+    MeshHandle Acquire(const std::string& key, MeshStats* stats = nullptr);
+    // Uploads `mesh` under `key`, or takes a reference to the mesh already resident under it.
+    // An empty key uploads an unshared mesh.
+    MeshHandle Upload(const std::string& key, const MeshData& mesh, const MeshStats& stats);
+    // Same for buffers uploaded elsewhere (GLUploadThread): creates their VAO, or deletes them
+    // and takes a reference if `key` became resident meanwhile.
+    MeshHandle Adopt(const std::string& key, MeshBuffers buffers, const MeshStats& stats);
+    // Deletes uploaded buffers nobody will adopt (their load was cancelled).
+    void Discard(MeshBuffers& buffers);
+    // Drops the reference held through `h` (destroying the mesh if it was the last) and clears `h`.
+    void Release(MeshHandle& h);
+    // Destroys every mesh regardless of references (shutdown).
+    void DestroyAll();
+
+    size_t MeshCount() const;
+    size_t ReferenceCount() const;
+    uint64_t ResidentBytes() const;
+
+private:
+    struct Entry {
+        MeshHandle handle;
+        MeshStats stats;
+        uint32_t refs = 0;
+        uint64_t bytes = 0;
+    };
+
+    GLRenderer* renderer_;
+    mutable std::mutex mtx_; // guards the maps below for Contains; GL calls stay on the GL thread
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<uint32_t, std::string> key_by_vao_;
+    MeshHandle Insert(const std::string& key, const MeshHandle& handle, const MeshStats& stats, uint64_t bytes);
+
+    uint64_t unshared_counter_ = 0;
+    size_t refs_ = 0;
+    uint64_t bytes_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "navigation_model.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+const char* NavigationModel::kStartState = "<start>";
+
+NavigationModel::NavigationModel(std::string path) : path_(std::move(path)) {}
+
+// File format: one "from<TAB>to<TAB>count" triple per line; '#' starts a comment. Tabs, since scene
+// ids are directory names and may contain spaces.
+bool NavigationModel::Load() {
+    std::ifstream ifs(path_);
+    if (!ifs) return true;
+
+    std::map<std::string, std::map<std::string, uint32_t>> loaded;
+    std::string line;
+    int line_no = 0;
+    bool all_ok = true;
+    while (std::getline(ifs, line)) {
+        ++line_no;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        std::string from, to, count_text;
+        char* count_end = nullptr;
+        unsigned long count = 0;
+        if (std::getline(ls, from, '\t') && std::getline(ls, to, '\t') && std::getline(ls, count_text)) {
+            count = std::strtoul(count_text.c_str(), &count_end, 10);
+        }
+        if (from.empty() || to.empty() || count_text.empty() || !count_end || *count_end != '\0') {
+            // One bad line shouldn't cost the rest of the history (the next Save would drop it).
+            std::cerr << "[NavigationModel] Skipping malformed line " << line_no << " in " << path_ << "\n";
+            all_ok = false;
+            continue;
+        }
+        loaded[from][to] += static_cast<uint32_t>(count);
+    }
+
+    std::scoped_lock lk(mtx_);
+    transitions_ = std::move(loaded);
+    dirty_ = false;
+    return all_ok;
+}
+
+bool NavigationModel::Save() {
+    std::ostringstream oss;
+    {
+        std::scoped_lock lk(mtx_);
+        if (!dirty_) return true;
+        oss << "# scene navigation transitions: from<TAB>to<TAB>count\n";
+        auto representable = [](const std::string& id) { return id.find_first_of("\t\r\n") == std::string::npos; };
+        for (auto& [from, row] : transitions_) {
+            if (!representable(from)) continue;
+            for (auto& [to, count] : row) {
+                if (representable(to)) oss << from << '\t' << to << '\t' << count << "\n";
+            }
+        }
+        dirty_ = false;
+    }
+
+    // Write-then-rename so a crash never leaves a truncated history.
+    std::error_code ec;
+    fs::path p(path_);
+    if (p.has_parent_path()) fs::create_directories(p.parent_path(), ec);
+    std::string tmp = path_ + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        if (!ofs || !(ofs << oss.str())) {
+            std::cerr << "[NavigationModel] Failed to write " << tmp << "\n";
+            return false;
+        }
+    }
+    fs::rename(tmp, p, ec);
+    if (ec) {
+        std::cerr << "[NavigationModel] Failed to replace " << path_ << ": " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void NavigationModel::RecordView(const std::string& scene_id) {
+    std::scoped_lock lk(mtx_);
+    if (scene_id == current_) return;
+    const std::string& from = current_.empty() ? std::string(kStartState) : current_;
+    ++transitions_[from][scene_id];
+    current_ = scene_id;
+    dirty_ = true;
+}
+
+std::vector<std::string> NavigationModel::PredictNext(const std::string& from, float min_probability) const {
+    std::scoped_lock lk(mtx_);
+    auto it = transitions_.find(from.empty() ? std::string(kStartState) : from);
+    if (it == transitions_.end()) return {};
+
+    uint64_t total = 0;
+    for (auto& [to, count] : it->second) total += count;
+    if (total == 0) return {};
+
+    std::vector<std::pair<std::string, uint32_t>> ranked;
+    for (auto& [to, count] : it->second) {
+        if (static_cast<float>(count) / static_cast<float>(total) >= min_probability) ranked.emplace_back(to, count);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    std::vector<std::string> out;
+    out.reserve(ranked.size());
+    for (auto& r : ranked) out.push_back(r.first);
+    return out;
+}
+
+std::string NavigationModel::Current() const {
+    std::scoped_lock lk(mtx_);
+    return current_;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// First-order Markov model of scene navigation, learned from View clicks.
+// Counts transitions "viewed A, then viewed B" and predicts the likely next scenes from the
+// current one. The first view of a session is recorded as a transition from a start state,
+// so recurring tours are predicted from launch. Persisted as a small text file across runs.
+class NavigationModel {
+public:
+    explicit NavigationModel(std::string path);
+
+    // Load counts from disk (missing file = empty model). Malformed lines are skipped; returns false
+    // if there were any.
+    bool Load();
+    // Write counts to disk if anything changed since the last Load/Save.
+    bool Save();
+
+    // The user viewed scene_id; records the transition from the previously viewed scene.
+    void RecordView(const std::string& scene_id);
+
+    // Scene ids that followed `from` with probability >= min_probability, most likely first.
+    // An empty `from` means "start of session".
+    std::vector<std::string> PredictNext(const std::string& from, float min_probability = 0.1f) const;
+
+    // Last scene viewed this session (empty before the first view).
+    std::string Current() const;
+
+private:
+    static const char* kStartState;
+
+    std::string path_;
+    mutable std::mutex mtx_;
+    std::string current_;
+    std::map<std::string, std::map<std::string, uint32_t>> transitions_;
+    bool dirty_ = false;
+};
\ No newline at end of file
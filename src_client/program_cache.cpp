@@ -0,0 +1,128 @@
+#include "program_cache.h"
+#include "sha256.h"
+#include <glad/glad.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+// File layout: magic, binary format (uint32), then the driver's blob.
+constexpr char kMagic[8] = { 'P', '4', 'P', 'R', 'O', 'G', '0', '1' };
+
+bool DriverSupportsBinaries() {
+    bool api = false;
+#ifdef GL_VERSION_4_1
+    api = api || GLAD_GL_VERSION_4_1;
+#endif
+#ifdef GL_ARB_get_program_binary
+    api = api || GLAD_GL_ARB_get_program_binary;
+#endif
+    if (!api) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+std::string GLString(GLenum name) {
+    const GLubyte* s = glGetString(name);
+    return s ? reinterpret_cast<const char*>(s) : "";
+}
+}
+
+bool ProgramBinaryCache::Init() {
+    enabled_ = false;
+    if (dir_.empty()) return false;
+    if (!DriverSupportsBinaries()) {
+        std::cerr << "[ProgramBinaryCache] Driver has no program binary formats; compiling from source\n";
+        return false;
+    }
+    driver_ = GLString(GL_VENDOR) + '\n' + GLString(GL_RENDERER) + '\n' + GLString(GL_VERSION);
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) {
+        std::cerr << "[ProgramBinaryCache] Can't create " << dir_ << ": " << ec.message() << "\n";
+        return false;
+    }
+    enabled_ = true;
+    return true;
+}
+
+std::string ProgramBinaryCache::PathFor(std::string_view vs_src, std::string_view fs_src) const {
+    std::string key;
+    key.reserve(driver_.size() + vs_src.size() + fs_src.size() + 2);
+    key.append(driver_).append(1, '\0').append(vs_src).append(1, '\0').append(fs_src);
+    return (fs::path(dir_) / (Sha256::HexDigest(key) + ".bin")).string();
+}
+
+uint32_t ProgramBinaryCache::Load(std::string_view vs_src, std::string_view fs_src) {
+    if (!enabled_) return 0;
+    const std::string path = PathFor(vs_src, fs_src);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    const size_t header = sizeof(kMagic) + sizeof(uint32_t);
+    if (data.size() <= header || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "[ProgramBinaryCache] Ignoring malformed " << path << "\n";
+        std::error_code ec;
+        fs::remove(path, ec);
+        return 0;
+    }
+    uint32_t format = 0;
+    std::memcpy(&format, data.data() + sizeof(kMagic), sizeof(format));
+
+    GLuint p = glCreateProgram();
+    glProgramBinary(p, format, data.data() + header, static_cast<GLsizei>(data.size() - header));
+    GLint ok = 0;
+    glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        // Same driver string, but the driver still refused it (e.g. a changed GPU configuration).
+        std::cerr << "[ProgramBinaryCache] Driver rejected " << path << "; rebuilding from source\n";
+        glDeleteProgram(p);
+        std::error_code ec;
+        fs::remove(path, ec);
+        return 0;
+    }
+    return p;
+}
+
+void ProgramBinaryCache::Store(uint32_t program, std::string_view vs_src, std::string_view fs_src) {
+    if (!enabled_ || !program) return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> blob(static_cast<size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, blob.data());
+    if (written <= 0) return;
+
+    // Write aside and rename, so a crash never leaves a truncated entry under the final name.
+    const std::string path = PathFor(vs_src, fs_src);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        uint32_t fmt = format;
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char*>(&fmt), sizeof(fmt));
+        out.write(blob.data(), written);
+        if (!out) {
+            std::cerr << "[ProgramBinaryCache] Failed to write " << tmp << "\n";
+            out.close();
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "[ProgramBinaryCache] Failed to store " << path << ": " << ec.message() << "\n";
+        fs::remove(tmp, ec);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Linked GL programs saved with glGetProgramBinary and restored with glProgramBinary, so later
+// launches skip compiling and linking GLSL. Entries are files named by a hash of the driver
+// (vendor, renderer, version) and the program's sources: a driver update or a shader edit simply
+// misses. A binary the driver rejects anyway is deleted and the program is built from source.
+//
+// All calls need the GL context current.
+class ProgramBinaryCache {
+public:
+    // An empty dir disables the cache.
+    explicit ProgramBinaryCache(std::string dir) : dir_(std::move(dir)) {}
+
+    // Reads the driver identity. Returns false (cache stays disabled) if there is no directory or
+    // the driver offers no binary formats.
+    bool Init();
+    bool Enabled() const { return enabled_; }
+
+    // A linked program from the cached binary for these sources, or 0.
+    uint32_t Load(std::string_view vs_src, std::string_view fs_src);
+    // Saves a linked program; link it with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    void Store(uint32_t program, std::string_view vs_src, std::string_view fs_src);
+
+private:
+    std::string PathFor(std::string_view vs_src, std::string_view fs_src) const;
+
+    std::string dir_;
+    std::string driver_;
+    bool enabled_ = false;
+};
\ No newline at end of file
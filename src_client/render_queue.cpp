@@ -0,0 +1,83 @@
+#include "render_queue.h"
+#include <bit>
+#include <limits>
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, RenderProgram program, uint32_t buffer, float view_depth) {
+    // Non-negative IEEE floats order like their bit patterns, so the depth sorts as an integer.
+    uint32_t depth = view_depth > 0.0f ? std::bit_cast<uint32_t>(view_depth) : 0u;
+    return (uint64_t(static_cast<uint8_t>(pass) & 0xF) << 60) |
+           (uint64_t(static_cast<uint8_t>(program) & 0xF) << 56) |
+           (uint64_t(buffer & 0xFFFFFF) << 32) |
+           depth;
+}
+
+void RenderQueue::Clear() {
+    packets_.clear();
+    matrices_.clear();
+}
+
+void RenderQueue::SubmitMesh(const MeshHandle& mesh, const glm::mat4& model, float view_depth, const glm::vec3& color) {
+    if (mesh.vao == 0) return;
+    DrawPacket p;
+    p.key = MakeKey(RenderPass::Opaque, RenderProgram::Mesh, mesh.vao, view_depth);
+    p.program = RenderProgram::Mesh;
+    p.mesh = mesh;
+    p.matrix = static_cast<uint32_t>(matrices_.size());
+    p.color = color;
+    matrices_.push_back(model);
+    packets_.push_back(p);
+}
+
+void RenderQueue::SubmitPlane(const glm::vec3& color) {
+    DrawPacket p;
+    p.key = MakeKey(RenderPass::Opaque, RenderProgram::Flat, 0, std::numeric_limits<float>::max());
+    p.program = RenderProgram::Flat;
+    p.color = color;
+    packets_.push_back(p);
+}
+
+void RenderQueue::SubmitSkybox() {
+    DrawPacket p;
+    p.key = MakeKey(RenderPass::Skybox, RenderProgram::Skybox, 0, 0.0f);
+    p.program = RenderProgram::Skybox;
+    packets_.push_back(p);
+}
+
+void RenderQueue::Sort() {
+    const size_t n = packets_.size();
+    if (n < 2) return;
+    scratch_.resize(n);
+
+    // Digits that are the same in every key (the pass and program bytes, most of the VAO bytes)
+    // don't change the order; find them up front and skip their passes.
+    uint64_t all_or = 0, all_and = ~uint64_t(0);
+    for (const DrawPacket& p : packets_) {
+        all_or |= p.key;
+        all_and &= p.key;
+    }
+    const uint64_t varying = all_or ^ all_and;
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & 0xFF) == 0) continue;
+        size_t offsets[256] = {};
+        for (const DrawPacket& p : packets_) ++offsets[(p.key >> shift) & 0xFF];
+        size_t sum = 0;
+        for (size_t& o : offsets) {
+            size_t count = o;
+            o = sum;
+            sum += count;
+        }
+        for (const DrawPacket& p : packets_) scratch_[offsets[(p.key >> shift) & 0xFF]++] = p;
+        packets_.swap(scratch_);
+    }
+
+    // Lay the matrices out in draw order, so each run of one mesh is a contiguous slice.
+    scratch_matrices_.clear();
+    for (DrawPacket& p : packets_) {
+        if (p.program != RenderProgram::Mesh) continue;
+        uint32_t sorted_index = static_cast<uint32_t>(scratch_matrices_.size());
+        scratch_matrices_.push_back(matrices_[p.matrix]);
+        p.matrix = sorted_index;
+    }
+    matrices_.swap(scratch_matrices_);
+}
\ No newline at end of file
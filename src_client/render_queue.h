@@ -0,0 +1,56 @@
+#pragma once
+
+#include "gl_renderer.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Passes execute in this order. The skybox goes last: it is drawn at the far plane with
+// GL_LEQUAL, so everything already in the depth buffer hides the texels it would overdraw.
+enum class RenderPass : uint8_t { Opaque = 0, Skybox = 1 };
+
+// Which GLRenderer program a packet draws with. Part of the sort key, so draws sharing a
+// program are contiguous and it is bound once per frame.
+enum class RenderProgram : uint8_t { Mesh = 0, Flat = 1, Skybox = 2 };
+
+// One draw. Model packets reference their matrix in RenderQueue::Matrices(); consecutive model
+// packets with the same VAO and color are executed as one instanced draw.
+struct DrawPacket {
+    uint64_t key = 0;
+    RenderProgram program = RenderProgram::Mesh;
+    MeshHandle mesh;
+    uint32_t matrix = 0;
+    glm::vec3 color{ 1.0f };
+};
+
+// Draws of one frame, submitted in any order and sorted by a 64-bit key before execution:
+//   [63..60 pass][59..56 program][55..32 buffer (VAO)][31..0 view depth]
+// Within a pass and program, draws of one mesh are adjacent (one bind, one instanced draw) and
+// ordered front to back, so opaque geometry that is drawn first rejects fragments behind it.
+class RenderQueue {
+public:
+    static uint64_t MakeKey(RenderPass pass, RenderProgram program, uint32_t buffer, float view_depth);
+
+    // Starts a new frame; keeps capacity.
+    void Clear();
+
+    // view_depth: distance along the view direction (anything <= 0 sorts first).
+    void SubmitMesh(const MeshHandle& mesh, const glm::mat4& model, float view_depth, const glm::vec3& color);
+    // The ground plane: after every model, since models cover parts of it but it covers none of them.
+    void SubmitPlane(const glm::vec3& color);
+    void SubmitSkybox();
+
+    // LSD radix sort on the keys (8-bit digits; digits equal across all packets are skipped),
+    // then reorders Matrices() to match so each mesh run reads a contiguous slice.
+    void Sort();
+
+    std::span<const DrawPacket> Packets() const { return packets_; }
+    const std::vector<glm::mat4>& Matrices() const { return matrices_; }
+
+private:
+    std::vector<DrawPacket> packets_;
+    std::vector<DrawPacket> scratch_;
+    std::vector<glm::mat4> matrices_;
+    std::vector<glm::mat4> scratch_matrices_;
+};
\ No newline at end of file
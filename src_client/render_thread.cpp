@@ -0,0 +1,132 @@
+#include "render_thread.h"
+#include "gl_renderer.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <imgui_impl_opengl3.h>
+#include <chrono>
+#include <iostream>
+
+void FramePacket::SetUi(const ImDrawData* src) {
+    ClearUi();
+    if (!src || !src->Valid) return;
+    ui = *src;
+    for (int n = 0; n < ui.CmdLists.Size; ++n) ui.CmdLists[n] = src->CmdLists[n]->CloneOutput();
+}
+
+void FramePacket::ClearUi() {
+    for (int n = 0; n < ui.CmdLists.Size; ++n) IM_DELETE(ui.CmdLists[n]);
+    ui.Clear();
+}
+
+void RenderThread::Start() {
+    if (running_) return;
+    stop_ = false;
+    glfwMakeContextCurrent(nullptr);
+    running_ = true;
+    thread_ = std::thread([this]() { Run(); });
+}
+
+void RenderThread::Stop() {
+    if (!running_) return;
+    {
+        std::scoped_lock lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    running_ = false;
+    glfwMakeContextCurrent(window_);
+    renderer_->ResetStateCache();
+    // Posted after the last Publish.
+    RunGLTasks(packets_[write_]);
+}
+
+void RenderThread::Publish() {
+    std::unique_lock lk(mtx_);
+    cv_.wait(lk, [&]() { return ready_ < 0 || stop_; });
+    if (stop_) return;
+    ready_ = write_;
+    // The slot that is neither ready nor being drawn is free for the next frame.
+    for (int i = 0; i < 3; ++i) {
+        if (i != ready_ && i != reading_) {
+            write_ = i;
+            break;
+        }
+    }
+    lk.unlock();
+    cv_.notify_all();
+}
+
+void RenderThread::PostGL(UniqueTask task) {
+    if (!running_) {
+        task();
+        return;
+    }
+    packets_[write_].gl_tasks.push_back(std::move(task));
+}
+
+void RenderThread::RunGLTasks(FramePacket& packet) {
+    for (UniqueTask& task : packet.gl_tasks) task();
+    packet.gl_tasks.clear();
+}
+
+void RenderThread::DrainUploads() {
+    // Swap the batch out so tasks run without the lock and loaders can keep posting meanwhile.
+    std::queue<UniqueTask> pending;
+    {
+        std::scoped_lock lk(upload_mtx_);
+        pending.swap(upload_queue_);
+    }
+    while (!pending.empty()) {
+        auto task = std::move(pending.front());
+        pending.pop();
+        task();
+    }
+}
+
+void RenderThread::Draw(FramePacket& packet) {
+    glViewport(0, 0, packet.display_w, packet.display_h);
+    glClearColor(0.1f, 0.12f, 0.15f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    renderer_->Execute(packet.queue, packet.view, packet.proj);
+    // Render ImGui on top
+    if (packet.ui.Valid) ImGui_ImplOpenGL3_RenderDrawData(&packet.ui);
+}
+
+void RenderThread::Run() {
+    glfwMakeContextCurrent(window_);
+    glfwSwapInterval(1);
+    renderer_->ResetStateCache();
+    std::cerr << "[RenderThread] Started\n";
+    while (true) {
+        int slot = -1;
+        {
+            std::unique_lock lk(mtx_);
+            cv_.wait(lk, [&]() { return ready_ >= 0 || stop_; });
+            if (ready_ >= 0) {
+                slot = ready_;
+                reading_ = ready_;
+                ready_ = -1;
+            }
+        }
+        cv_.notify_all(); // Publish may be waiting for the slot to be picked up
+        if (slot < 0) break; // stopping with nothing published
+
+        FramePacket& packet = packets_[slot];
+        auto start = std::chrono::steady_clock::now();
+        RunGLTasks(packet);
+        DrainUploads();
+        bool stopping;
+        {
+            std::scoped_lock lk(mtx_);
+            stopping = stop_;
+        }
+        if (stopping) break; // the frame's GL work ran; skip drawing it
+        Draw(packet);
+        last_frame_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        glfwSwapBuffers(window_);
+    }
+    glfwMakeContextCurrent(nullptr);
+    std::cerr << "[RenderThread] Stopped\n";
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "render_queue.h"
+#include "unique_task.h"
+#include <imgui.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct GLFWwindow;
+class GLRenderer;
+
+// Everything the render thread needs to draw one frame, built by the main thread.
+struct FramePacket {
+    FramePacket() = default;
+    FramePacket(const FramePacket&) = delete;
+    FramePacket& operator=(const FramePacket&) = delete;
+    ~FramePacket() { ClearUi(); }
+
+    RenderQueue queue;
+    glm::mat4 view{ 1.0f };
+    glm::mat4 proj{ 1.0f };
+    int display_w = 0;
+    int display_h = 0;
+    // Deep copy of the frame's ImGui output: ImGui reuses its own draw lists on the next NewFrame,
+    // while the render thread may still be drawing this one.
+    ImDrawData ui;
+    // Main-thread GL work (e.g. freeing an unloaded scene's meshes), run before this frame is
+    // drawn. Frames built earlier may still reference those meshes, so it can't run any sooner.
+    std::vector<UniqueTask> gl_tasks;
+
+    // Main thread (ImGui allocates the copies).
+    void SetUi(const ImDrawData* src);
+    void ClearUi();
+};
+
+// Owns the GL context while running and draws the frames the main thread publishes, so building
+// the UI and the next frame's draw list overlaps rendering the previous one. Packets are triple
+// buffered: one being drawn, one ready, one being filled. The main thread waits in Publish only
+// if it gets a whole frame ahead, which also paces it to the display.
+//
+// While running, the render thread also runs the loader's GL upload queue. Before Start and after
+// Stop the context belongs to the main thread again.
+class RenderThread {
+public:
+    RenderThread(GLFWwindow* window, GLRenderer* renderer, std::queue<UniqueTask>& upload_queue, std::mutex& upload_mtx)
+        : window_(window), renderer_(renderer), upload_queue_(upload_queue), upload_mtx_(upload_mtx) {}
+    ~RenderThread() { Stop(); }
+
+    // Main thread, context current: hands the context to a new render thread.
+    void Start();
+    // Main thread: draws nothing more, runs GL work still pending and makes the context current
+    // on the calling thread again.
+    void Stop();
+    bool Running() const { return running_; }
+
+    // ---- main thread ----
+    // The packet to fill for the next frame (never one the render thread is reading).
+    FramePacket& Frame() { return packets_[write_]; }
+    // Hands Frame() to the render thread; blocks while the previous one hasn't been picked up.
+    void Publish();
+    // GL work that must run on the context's thread after frames already published: queued with
+    // the next frame while running, executed right away otherwise.
+    void PostGL(UniqueTask task);
+
+    // Milliseconds the render thread spent on its last frame, swap excluded.
+    double LastFrameMs() const { return last_frame_ms_.load(); }
+
+private:
+    void Run();
+    void RunGLTasks(FramePacket& packet);
+    void DrainUploads();
+    void Draw(FramePacket& packet);
+
+    GLFWwindow* window_;
+    GLRenderer* renderer_;
+    std::queue<UniqueTask>& upload_queue_;
+    std::mutex& upload_mtx_;
+
+    FramePacket packets_[3];
+    int write_ = 0;    // main thread's
+    int ready_ = -1;   // published, not yet picked up; guarded by mtx_
+    int reading_ = -1; // render thread's; guarded by mtx_
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+    bool running_ = false;
+    std::atomic<double> last_frame_ms_{ 0.0 };
+};
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "render_world.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <limits>
+
+void RenderWorld::Post(Event ev) {
+    std::scoped_lock lk(inbox_mtx_);
+    inbox_.push_back(std::move(ev));
+}
+
+void RenderWorld::PostModelReady(const std::string& scene_id, uint32_t model_index, const MeshHandle& mesh,
+                                 const glm::mat4& local_transform, const ModelBounds& bounds) {
+    Event ev(EventKind::MODEL_READY, scene_id);
+    ev.model_index = model_index;
+    ev.mesh = mesh;
+    ev.local_transform = local_transform;
+    ev.bounds = bounds;
+    Post(std::move(ev));
+}
+
+void RenderWorld::PostModelPlaced(const std::string& scene_id, uint32_t model_index,
+                                  const glm::mat4& local_transform, const ModelBounds& bounds) {
+    Event ev(EventKind::MODEL_PLACED, scene_id);
+    ev.model_index = model_index;
+    ev.local_transform = local_transform;
+    ev.bounds = bounds;
+    Post(std::move(ev));
+}
+
+void RenderWorld::PostSceneLoaded(const std::string& scene_id, bool loaded) {
+    Event ev(EventKind::SCENE_LOADED, scene_id);
+    ev.loaded = loaded;
+    Post(std::move(ev));
+}
+
+void RenderWorld::PostSceneCleared(const std::string& scene_id) {
+    Post(Event(EventKind::SCENE_CLEARED, scene_id));
+}
+
+void RenderWorld::PostActiveModel(const std::string& scene_id, int model_index) {
+    Event ev(EventKind::ACTIVE_MODEL, scene_id);
+    ev.model_index = static_cast<uint32_t>(model_index < 0 ? 0 : model_index);
+    Post(std::move(ev));
+}
+
+uint16_t RenderWorld::AddScene(const std::string& scene_id) {
+    return SlotFor(scene_id);
+}
+
+uint16_t RenderWorld::SlotFor(const std::string& scene_id) {
+    auto it = slot_by_id_.find(scene_id);
+    if (it != slot_by_id_.end()) return it->second;
+    uint16_t slot = static_cast<uint16_t>(scene_ids_.size());
+    scene_ids_.push_back(scene_id);
+    active_models_.push_back(0);
+    scene_loaded_.push_back(0);
+    scene_shown_.push_back(0);
+    slot_by_id_.emplace(scene_id, slot);
+    visible_dirty_ = true;
+    return slot;
+}
+
+bool RenderWorld::ApplyEvents() {
+    {
+        std::scoped_lock lk(inbox_mtx_);
+        if (inbox_.empty()) return false;
+        applying_.swap(inbox_);
+    }
+
+    for (auto& ev : applying_) {
+        uint16_t slot = SlotFor(ev.scene_id);
+        switch (ev.kind) {
+        case EventKind::MODEL_PLACED:
+        case EventKind::MODEL_READY: {
+            uint64_t key = Key(slot, ev.model_index);
+            auto it = dense_index_.find(key);
+            uint32_t i;
+            if (it != dense_index_.end()) {
+                i = it->second;
+            } else {
+                i = static_cast<uint32_t>(meshes_.size());
+                meshes_.emplace_back();
+                local_transforms_.emplace_back(1.0f);
+                // Placement depends only on (scene, model index): compute it once per model.
+                placements_.push_back(placement_fn_ ? placement_fn_(ev.scene_id, slot, ev.model_index) : glm::vec3(0.0f));
+                world_matrices_.emplace_back(1.0f);
+                transform_dirty_.push_back(1);
+                bvh_proxies_.push_back(DynamicBVH::kNull);
+                world_centers_.emplace_back(0.0f);
+                bounds_.emplace_back();
+                scene_slots_.push_back(slot);
+                model_indices_.push_back(ev.model_index);
+                dense_index_.emplace(key, i);
+            }
+            if (ev.kind == EventKind::MODEL_READY) meshes_[i] = ev.mesh;
+            local_transforms_[i] = ev.local_transform;
+            bounds_[i] = ev.bounds;
+            transform_dirty_[i] = 1;
+            any_transform_dirty_ = true;
+            break;
+        }
+        case EventKind::SCENE_LOADED:
+            scene_loaded_[slot] = ev.loaded ? 1 : 0;
+            break;
+        case EventKind::SCENE_CLEARED:
+            RemoveScene(slot);
+            scene_loaded_[slot] = 0;
+            active_models_[slot] = 0;
+            break;
+        case EventKind::ACTIVE_MODEL:
+            active_models_[slot] = static_cast<int>(ev.model_index);
+            break;
+        }
+    }
+    applying_.clear();
+    visible_dirty_ = true;
+    RebuildDirtyTransforms();
+    return true;
+}
+
+void RenderWorld::RebuildDirtyTransforms() {
+    if (!any_transform_dirty_) return;
+    any_transform_dirty_ = false;
+    for (size_t i = 0; i < world_matrices_.size(); ++i) {
+        if (!transform_dirty_[i]) continue;
+        transform_dirty_[i] = 0;
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), placements_[i]) * local_transforms_[i];
+        // keep vertical alignment (preserve placement Y)
+        m[3].y = placements_[i].y;
+        world_matrices_[i] = m;
+
+        // World and local matrices share the linear part, so bounds only move by the translation delta.
+        world_centers_[i] = bounds_[i].center + glm::vec3(m[3] - local_transforms_[i][3]);
+        Aabb box = Aabb::FromSphere(world_centers_[i], bounds_[i].radius);
+        if (bvh_proxies_[i] == DynamicBVH::kNull) bvh_proxies_[i] = bvh_.Insert(box, static_cast<uint32_t>(i));
+        else bvh_.Update(bvh_proxies_[i], box);
+    }
+}
+
+void RenderWorld::RemoveAt(uint32_t i) {
+    uint32_t last = static_cast<uint32_t>(meshes_.size() - 1);
+    dense_index_.erase(Key(scene_slots_[i], model_indices_[i]));
+    if (bvh_proxies_[i] != DynamicBVH::kNull) bvh_.Remove(bvh_proxies_[i]);
+    if (i != last) {
+        meshes_[i] = meshes_[last];
+        local_transforms_[i] = local_transforms_[last];
+        placements_[i] = placements_[last];
+        world_matrices_[i] = world_matrices_[last];
+        transform_dirty_[i] = transform_dirty_[last];
+        bvh_proxies_[i] = bvh_proxies_[last];
+        world_centers_[i] = world_centers_[last];
+        if (bvh_proxies_[i] != DynamicBVH::kNull) bvh_.SetUserData(bvh_proxies_[i], i);
+        bounds_[i] = bounds_[last];
+        scene_slots_[i] = scene_slots_[last];
+        model_indices_[i] = model_indices_[last];
+        dense_index_[Key(scene_slots_[i], model_indices_[i])] = i;
+    }
+    meshes_.pop_back();
+    local_transforms_.pop_back();
+    placements_.pop_back();
+    world_matrices_.pop_back();
+    transform_dirty_.pop_back();
+    bvh_proxies_.pop_back();
+    world_centers_.pop_back();
+    bounds_.pop_back();
+    scene_slots_.pop_back();
+    model_indices_.pop_back();
+}
+
+void RenderWorld::RemoveScene(uint16_t slot) {
+    // Walk backwards so swapped-in elements have already been examined.
+    for (size_t i = meshes_.size(); i-- > 0;) {
+        if (scene_slots_[i] == slot) RemoveAt(static_cast<uint32_t>(i));
+    }
+}
+
+void RenderWorld::SetViewFilter(bool show_any, const std::string& only_scene) {
+    if (show_any == show_any_ && only_scene == only_scene_) return;
+    show_any_ = show_any;
+    only_scene_ = only_scene;
+    visible_dirty_ = true;
+}
+
+const std::vector<uint32_t>& RenderWorld::VisibleIndices() {
+    if (!visible_dirty_) return visible_;
+    visible_dirty_ = false;
+
+    for (size_t s = 0; s < scene_ids_.size(); ++s) {
+        scene_shown_[s] = (show_any_ && scene_loaded_[s] && (only_scene_.empty() || scene_ids_[s] == only_scene_)) ? 1 : 0;
+    }
+    visible_.clear();
+    model_shown_.assign(meshes_.size(), 0);
+    for (uint32_t i = 0; i < meshes_.size(); ++i) {
+        uint16_t slot = scene_slots_[i];
+        if (scene_shown_[slot] && model_indices_[i] == static_cast<uint32_t>(active_models_[slot]) && meshes_[i].vao != 0) {
+            visible_.push_back(i);
+            model_shown_[i] = 1;
+        }
+    }
+    return visible_;
+}
+
+const std::vector<uint32_t>& RenderWorld::CullVisible(const Frustum& frustum) {
+    VisibleIndices(); // refresh model_shown_
+    culled_.clear();
+    if (visible_.empty()) return culled_;
+    bvh_.QueryFrustum(frustum, [&](uint32_t i) {
+        if (model_shown_[i]) culled_.push_back(i);
+    });
+    return culled_;
+}
+
+int64_t RenderWorld::Pick(const glm::vec3& origin, const glm::vec3& dir) {
+    VisibleIndices(); // refresh model_shown_ after ApplyEvents / SetViewFilter
+    int64_t best = -1;
+    float best_t = std::numeric_limits<float>::max();
+    glm::vec3 d = glm::normalize(dir);
+    bvh_.QueryRay(origin, d, std::numeric_limits<float>::max(), [&](uint32_t i, float box_t) -> float {
+        (void)box_t;
+        if (!model_shown_[i]) return best_t;
+        // exact ray/sphere: |o + t d - c|^2 = r^2
+        glm::vec3 oc = origin - world_centers_[i];
+        float b = glm::dot(oc, d);
+        float c = glm::dot(oc, oc) - bounds_[i].radius * bounds_[i].radius;
+        float disc = b * b - c;
+        if (disc < 0.0f) return best_t;
+        float t = std::max(-b - std::sqrt(disc), 0.0f); // 0 when the origin is inside the sphere
+        if (-b + std::sqrt(disc) < 0.0f || t >= best_t) return best_t; // behind the ray or farther
+        best = static_cast<int64_t>(i);
+        best_t = t;
+        return best_t;
+    });
+    return best;
+}
+
+void RenderWorld::QueryRadius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const {
+    out.clear();
+    bvh_.QueryRadius(center, radius, [&](uint32_t i) { out.push_back(i); });
+}
\ No newline at end of file
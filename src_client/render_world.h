@@ -0,0 +1,132 @@
+#pragma once
+
+#include "scene_types.h"
+#include "bvh.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Render-side view of every uploaded model, stored as parallel arrays (structure of arrays).
+// Loader threads describe changes with Post*() calls; the main thread applies them once per frame
+// in ApplyEvents() and then sweeps the arrays without taking any SceneDescriptor locks while it
+// builds the frame's RenderQueue (the RenderThread only sees the finished queue).
+class RenderWorld {
+public:
+    // World-space position for a model, derived only from its scene and index. Evaluated once
+    // when the model arrives, never per frame.
+    using PlacementFn = std::function<glm::vec3(const std::string& scene_id, uint16_t scene_slot, uint32_t model_index)>;
+
+    // ---- any thread ----
+    // A model's placement is known (manifest bounds) but its geometry isn't loaded yet. It joins
+    // the spatial index right away but isn't drawn until PostModelReady.
+    void PostModelPlaced(const std::string& scene_id, uint32_t model_index,
+                         const glm::mat4& local_transform, const ModelBounds& bounds);
+    // A model finished its GL upload.
+    void PostModelReady(const std::string& scene_id, uint32_t model_index, const MeshHandle& mesh,
+                        const glm::mat4& local_transform, const ModelBounds& bounds);
+    // Scene became drawable (LOADED) or stopped being drawable.
+    void PostSceneLoaded(const std::string& scene_id, bool loaded);
+    // Drop every model of the scene (unload / reload). The meshes are owned by the descriptor.
+    void PostSceneCleared(const std::string& scene_id);
+    // The scene's visible model changed (Prev/Next).
+    void PostActiveModel(const std::string& scene_id, int model_index);
+
+    // ---- main thread only (the thread building frames) ----
+    // Scenes keep their registration slot (slots follow registration order, and a scene cleared
+    // because it left the catalog keeps its slot).
+    uint16_t AddScene(const std::string& scene_id);
+
+    // Set before models arrive; models without a placement sit at the origin.
+    void SetPlacement(PlacementFn fn) { placement_fn_ = std::move(fn); }
+
+    // Apply posted events and rebuild the world matrices they dirtied. Returns true if anything changed.
+    bool ApplyEvents();
+
+    // Which scenes are drawn: none, all, or only `only_scene` (ignored unless show_any).
+    void SetViewFilter(bool show_any, const std::string& only_scene);
+
+    // Dense indices of models to draw this frame (one per visible scene: its active model).
+    const std::vector<uint32_t>& VisibleIndices();
+
+    // Spatial queries over world-space bounds of every model (BVH, not a linear scan).
+    // Shown models whose bounds intersect the frustum.
+    const std::vector<uint32_t>& CullVisible(const Frustum& frustum);
+    // Nearest shown model hit by the ray (bounding sphere test), or -1. Refreshes which models are
+    // shown first, like CullVisible.
+    int64_t Pick(const glm::vec3& origin, const glm::vec3& dir);
+    // All models (shown, hidden or still downloading) whose bounds overlap the sphere; e.g. for
+    // proximity-based loading.
+    void QueryRadius(const glm::vec3& center, float radius, std::vector<uint32_t>& out) const;
+
+    size_t ModelCount() const { return meshes_.size(); }
+    const MeshHandle& Mesh(uint32_t i) const { return meshes_[i]; }
+    const glm::mat4& LocalTransform(uint32_t i) const { return local_transforms_[i]; }
+    // translate(placement) * local, cached until the model changes.
+    const glm::mat4& WorldMatrix(uint32_t i) const { return world_matrices_[i]; }
+    const ModelBounds& Bounds(uint32_t i) const { return bounds_[i]; }
+    // Center of the world-space bounding sphere.
+    const glm::vec3& WorldCenter(uint32_t i) const { return world_centers_[i]; }
+    uint16_t SceneSlot(uint32_t i) const { return scene_slots_[i]; }
+    uint32_t ModelIndex(uint32_t i) const { return model_indices_[i]; }
+    const std::string& SceneId(uint16_t slot) const { return scene_ids_[slot]; }
+
+private:
+    enum class EventKind { MODEL_PLACED, MODEL_READY, SCENE_LOADED, SCENE_CLEARED, ACTIVE_MODEL };
+    struct Event {
+        Event(EventKind k, std::string id) : kind(k), scene_id(std::move(id)) {}
+        EventKind kind;
+        std::string scene_id;
+        uint32_t model_index = 0;
+        MeshHandle mesh;
+        glm::mat4 local_transform{ 1.0f };
+        ModelBounds bounds;
+        bool loaded = false;
+    };
+
+    void Post(Event ev);
+    uint16_t SlotFor(const std::string& scene_id);
+    void RemoveAt(uint32_t i);
+    void RemoveScene(uint16_t slot);
+    void RebuildDirtyTransforms();
+    static uint64_t Key(uint16_t slot, uint32_t model_index) { return (uint64_t(slot) << 32) | model_index; }
+
+    std::mutex inbox_mtx_;
+    std::vector<Event> inbox_;
+    std::vector<Event> applying_; // reused between frames
+
+    // per model (dense; removal swaps with the last element)
+    std::vector<MeshHandle> meshes_;
+    std::vector<glm::mat4> local_transforms_;
+    std::vector<glm::vec3> placements_;
+    std::vector<glm::mat4> world_matrices_;
+    std::vector<uint8_t> transform_dirty_;
+    std::vector<int32_t> bvh_proxies_;
+    std::vector<glm::vec3> world_centers_;
+    std::vector<ModelBounds> bounds_;
+    std::vector<uint16_t> scene_slots_;
+    std::vector<uint32_t> model_indices_;
+    std::unordered_map<uint64_t, uint32_t> dense_index_;
+
+    // per scene slot
+    std::vector<std::string> scene_ids_;
+    std::vector<int> active_models_;
+    std::vector<uint8_t> scene_loaded_;
+    std::vector<uint8_t> scene_shown_;
+    std::unordered_map<std::string, uint16_t> slot_by_id_;
+
+    PlacementFn placement_fn_;
+    bool any_transform_dirty_ = false;
+
+    DynamicBVH bvh_; // leaf user data = dense model index
+
+    bool show_any_ = false;
+    std::string only_scene_;
+    bool visible_dirty_ = true;
+    std::vector<uint32_t> visible_;
+    std::vector<uint8_t> model_shown_;
+    std::vector<uint32_t> culled_;
+};
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "scene_catalog.h"
+#include <algorithm>
+#include <iostream>
+
+// Reconnect delays for the watch stream.
+static constexpr auto kMinBackoff = std::chrono::milliseconds(250);
+static constexpr auto kMaxBackoff = std::chrono::milliseconds(10000);
+
+SceneCatalog::SceneCatalog(SceneClient* client) : client_(client) {}
+
+SceneCatalog::~SceneCatalog() {
+    Stop();
+}
+
+bool SceneCatalog::LoadInitial(std::vector<scene::SceneSummary>& out) {
+    out.clear();
+    int64_t version = 0;
+    if (!ListAll(out, version)) return false;
+    known_.clear();
+    for (const auto& s : out) known_[s.scene_id()] = s.fingerprint();
+    version_ = version;
+    listed_ = true;
+    std::cerr << "[SceneCatalog] " << out.size() << " scenes at catalog version " << version << "\n";
+    return true;
+}
+
+void SceneCatalog::StartWatching() {
+    if (thread_.joinable()) return;
+    thread_ = std::thread(&SceneCatalog::WatchThread, this);
+}
+
+void SceneCatalog::Stop() {
+    // Cancelling aborts a blocked WatchScenes read right away.
+    stop_token_->Cancel();
+    // Pass through the lock so a WaitFor between its check and its wait can't miss the notify.
+    { std::scoped_lock lk(mtx_); }
+    stop_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+std::vector<scene::SceneChange> SceneCatalog::TakeChanges() {
+    std::vector<scene::SceneChange> out;
+    std::scoped_lock lk(mtx_);
+    out.swap(pending_);
+    return out;
+}
+
+bool SceneCatalog::ListAll(std::vector<scene::SceneSummary>& out, int64_t& version) {
+    std::string token;
+    do {
+        scene::ListScenesResponse page;
+        if (!client_->ListScenes(token, 0, page)) return false;
+        // The first page's version is the safe resume point: later pages may already include
+        // changes made after it, and replaying those is harmless.
+        if (token.empty()) version = page.catalog_version();
+        for (auto& s : *page.mutable_scenes()) out.push_back(std::move(s));
+        token = page.next_page_token();
+    } while (!token.empty());
+    return true;
+}
+
+bool SceneCatalog::Resync() {
+    std::vector<scene::SceneSummary> listed;
+    int64_t version = 0;
+    if (!ListAll(listed, version)) return false;
+
+    std::map<std::string, std::string> seen;
+    for (const auto& s : listed) {
+        seen[s.scene_id()] = s.fingerprint();
+        scene::SceneChange change;
+        change.set_kind(known_.count(s.scene_id()) ? scene::SceneChange::CHANGED : scene::SceneChange::ADDED);
+        *change.mutable_scene() = s;
+        change.set_catalog_version(version);
+        Apply(change);
+    }
+    std::vector<std::string> removed;
+    for (const auto& [id, fingerprint] : known_) {
+        if (!seen.count(id)) removed.push_back(id);
+    }
+    for (const auto& id : removed) {
+        scene::SceneChange change;
+        change.set_kind(scene::SceneChange::REMOVED);
+        change.mutable_scene()->set_scene_id(id);
+        change.set_catalog_version(version);
+        Apply(change);
+    }
+    version_ = version;
+    listed_ = true;
+    return true;
+}
+
+void SceneCatalog::Apply(const scene::SceneChange& change) {
+    const std::string& id = change.scene().scene_id();
+    auto it = known_.find(id);
+    switch (change.kind()) {
+    case scene::SceneChange::ADDED:
+    case scene::SceneChange::CHANGED: {
+        // A replayed or re-listed scene whose content is unchanged isn't worth a reload.
+        if (it != known_.end() && it->second == change.scene().fingerprint()) return;
+        scene::SceneChange out = change;
+        out.set_kind(it == known_.end() ? scene::SceneChange::ADDED : scene::SceneChange::CHANGED);
+        known_[id] = change.scene().fingerprint();
+        std::scoped_lock lk(mtx_);
+        pending_.push_back(std::move(out));
+        return;
+    }
+    case scene::SceneChange::REMOVED: {
+        if (it == known_.end()) return;
+        known_.erase(it);
+        std::scoped_lock lk(mtx_);
+        pending_.push_back(change);
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+bool SceneCatalog::WaitFor(std::chrono::milliseconds delay) {
+    std::unique_lock lk(mtx_);
+    return !stop_cv_.wait_for(lk, delay, [this]() { return stop_token_->IsCancelled(); });
+}
+
+// Watch thread: keep one WatchScenes stream open, resuming from the last version seen.
+void SceneCatalog::WatchThread() {
+    auto backoff = kMinBackoff;
+    while (!stop_token_->IsCancelled()) {
+        if (!listed_ && !Resync()) {
+            if (!WaitFor(backoff)) break;
+            backoff = std::min(backoff * 2, kMaxBackoff);
+            continue;
+        }
+
+        bool resync = false;
+        bool received = false;
+        bool ok = client_->WatchScenes(version_, [&](const scene::SceneChange& change) {
+            received = true;
+            if (change.kind() == scene::SceneChange::RESYNC) {
+                resync = true;
+                return;
+            }
+            Apply(change);
+            version_ = std::max(version_, change.catalog_version());
+        }, stop_token_);
+        if (stop_token_->IsCancelled()) break;
+
+        if (resync) {
+            std::cerr << "[SceneCatalog] Change history expired, listing the catalog again\n";
+            listed_ = false;
+            continue;
+        }
+        if (received) backoff = kMinBackoff;
+        if (!ok) std::cerr << "[SceneCatalog] Watch stream lost, reconnecting in " << backoff.count() << " ms\n";
+        if (!WaitFor(backoff)) break;
+        backoff = std::min(backoff * 2, kMaxBackoff);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "scene_client.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Client-side copy of the server's scene catalog. LoadInitial pages through ListScenes once;
+// StartWatching then follows WatchScenes on a dedicated thread, reconnecting with backoff. If the
+// server's change history no longer reaches back to our version (RESYNC), the catalog is listed
+// again and the differences are reported as ordinary ADDED/CHANGED/REMOVED changes, so the
+// consumer never sees RESYNC.
+class SceneCatalog {
+public:
+    explicit SceneCatalog(SceneClient* client);
+    ~SceneCatalog();
+
+    // Every scene on the server, ordered by id. Returns false if the catalog couldn't be listed;
+    // the watch thread then lists it itself once the server is reachable.
+    bool LoadInitial(std::vector<scene::SceneSummary>& out);
+
+    void StartWatching();
+    void Stop();
+
+    // Changes received since the previous call, oldest first (drained by the main thread).
+    std::vector<scene::SceneChange> TakeChanges();
+
+private:
+    void WatchThread();
+    bool ListAll(std::vector<scene::SceneSummary>& out, int64_t& version);
+    // List again and queue the differences against known_. Watch thread only.
+    bool Resync();
+    // Record a change in known_ and queue it unless it's a no-op. Watch thread only.
+    void Apply(const scene::SceneChange& change);
+    // Sleep up to `delay`; returns false if Stop was called.
+    bool WaitFor(std::chrono::milliseconds delay);
+
+    SceneClient* client_;
+    std::shared_ptr<CancelToken> stop_token_ = CancelToken::Create();
+    std::thread thread_;
+
+    // scene id -> fingerprint as last reported; owned by LoadInitial, then by the watch thread.
+    std::map<std::string, std::string> known_;
+    int64_t version_ = 0;
+    bool listed_ = false;
+
+    std::mutex mtx_;
+    std::condition_variable stop_cv_;
+    std::vector<scene::SceneChange> pending_;
+};
\ No newline at end of file
@@ -1,23 +1,321 @@
 #include "scene_client.h"
 #include "sceneloader.pb.h"
 #include "sceneloader.grpc.pb.h"
-#include <fstream>
 #include <iostream>
-#include <filesystem>
 
-namespace fs = std::filesystem;
+static void ApplyTimeout(grpc::ClientContext& ctx, std::chrono::milliseconds timeout) {
+    if (timeout.count() > 0) ctx.set_deadline(std::chrono::system_clock::now() + timeout);
+}
+
+// Routes a CancelToken to a synchronous call's context for the lifetime of the scope. The token's
+// callback may still be running after Unregister returns, so it reaches the context through a
+// guard that is cleared before the context goes out of scope.
+class SyncCallCanceller {
+public:
+    SyncCallCanceller(grpc::ClientContext& ctx, std::shared_ptr<CancelToken> cancel)
+        : cancel_(std::move(cancel)), guard_(std::make_shared<Guard>()) {
+        guard_->ctx = &ctx;
+        if (cancel_) {
+            cb_ = cancel_->OnCancel([guard = guard_]() {
+                std::scoped_lock lk(guard->mtx);
+                if (guard->ctx) guard->ctx->TryCancel();
+            });
+        }
+    }
+    ~SyncCallCanceller() {
+        if (cancel_) cancel_->Unregister(cb_);
+        std::scoped_lock lk(guard_->mtx);
+        guard_->ctx = nullptr;
+    }
+    SyncCallCanceller(const SyncCallCanceller&) = delete;
+    SyncCallCanceller& operator=(const SyncCallCanceller&) = delete;
+
+private:
+    struct Guard {
+        std::mutex mtx;
+        grpc::ClientContext* ctx = nullptr;
+    };
+    std::shared_ptr<CancelToken> cancel_;
+    std::shared_ptr<Guard> guard_;
+    CancelToken::CallbackId cb_ = 0;
+};
+
+// Base for calls driven by the completion queue. Only one operation per call is outstanding
+// at a time, so the call object itself is the tag and Proceed() advances its state machine.
+class SceneClient::AsyncCall {
+public:
+    explicit AsyncCall(std::shared_ptr<CancelToken> cancel) : cancel_(std::move(cancel)) {}
+    virtual ~AsyncCall() = default;
+    virtual void Start(scene::SceneService::Stub* stub, grpc::CompletionQueue* cq) = 0;
+    // Advance after a completion. Returns true once the call is done and can be deleted.
+    virtual bool Proceed(bool ok) = 0;
+    // Called when the client drops the call without starting it.
+    virtual void Abandon() = 0;
+
+    // Thread-safe: gRPC allows TryCancel from any thread.
+    void Cancel() { ctx_.TryCancel(); }
+    // Must be called before Start.
+    void SetTimeout(std::chrono::milliseconds timeout) { ApplyTimeout(ctx_, timeout); }
+    bool CancelRequested() const { return cancel_ && cancel_->IsCancelled(); }
+
+protected:
+    friend class SceneClient;
+    grpc::ClientContext ctx_;
+    std::shared_ptr<CancelToken> cancel_;
+    CancelToken::CallbackId cancel_cb_ = 0;
+    uint64_t id_ = 0; // key in SceneClient::calls_; cancel callbacks hold this, not the pointer
+    size_t channel_ = 0; // index into SceneClient::channels_
+};
+
+// One async server-streaming Chunk download (StartCall -> Read* -> Finish): a model or a scene
+// pack, depending on how `prepare` opens the stream.
+class SceneClient::AsyncChunkCall final : public SceneClient::AsyncCall {
+public:
+    using PrepareFn = std::function<std::unique_ptr<grpc::ClientAsyncReader<scene::Chunk>>(
+        scene::SceneService::Stub*, grpc::ClientContext*, grpc::CompletionQueue*)>;
+
+    // op: the SceneClient method that started the stream, for log messages.
+    // keep_partial: on failure hand the bytes received so far to done_cb (for resuming) instead
+    // of an empty string.
+    AsyncChunkCall(PrepareFn prepare, const char* op, std::string label, int64_t total_bytes,
+                   std::function<void(int64_t, int64_t)> progress_cb,
+                   DownloadDoneCallback done_cb, std::shared_ptr<CancelToken> cancel, bool keep_partial = false)
+        : AsyncCall(std::move(cancel)), prepare_(std::move(prepare)), op_(op), label_(std::move(label)), total_bytes_(total_bytes),
+          progress_cb_(std::move(progress_cb)), done_cb_(std::move(done_cb)), keep_partial_(keep_partial) {
+        if (total_bytes_ > 0) data_.reserve(static_cast<size_t>(total_bytes_));
+    }
+
+    void Start(scene::SceneService::Stub* stub, grpc::CompletionQueue* cq) override {
+        reader_ = prepare_(stub, &ctx_, cq);
+        state_ = State::STARTING;
+        reader_->StartCall(this);
+    }
+
+    bool Proceed(bool ok) override {
+        switch (state_) {
+        case State::STARTING:
+            if (!ok) { FinishCall(); return false; }
+            ReadNext();
+            return false;
+        case State::READING:
+            if (!ok) { FinishCall(); return false; }
+            if (!cancelled_ && CancelRequested()) {
+                std::cerr << op_ << ": cancellation detected for " << label_ << "\n";
+                cancelled_ = true;
+                ctx_.TryCancel();
+            }
+            if (!cancelled_ && chunk_.data().size() > 0) {
+                data_.append(chunk_.data());
+                int64_t total = total_bytes_ > 0 ? total_bytes_ : chunk_.total_size();
+                if (progress_cb_) progress_cb_(static_cast<int64_t>(data_.size()), total);
+            }
+            ReadNext();
+            return false;
+        case State::FINISHING: {
+            cancelled_ = cancelled_ || CancelRequested();
+            bool success = status_.ok() && !cancelled_;
+            if (!status_.ok() && !cancelled_ && status_.error_code() != grpc::StatusCode::CANCELLED) {
+                std::cerr << op_ << " failed for " << label_ << ": " << status_.error_message() << "\n";
+            }
+            if (done_cb_) done_cb_(success, success || keep_partial_ ? std::move(data_) : std::string());
+            return true;
+        }
+        }
+        return true;
+    }
+
+    void Abandon() override {
+        if (done_cb_) done_cb_(false, std::string());
+    }
+
+private:
+    enum class State { STARTING, READING, FINISHING };
+
+    void ReadNext() {
+        state_ = State::READING;
+        reader_->Read(&chunk_, this);
+    }
+
+    void FinishCall() {
+        state_ = State::FINISHING;
+        reader_->Finish(&status_, this);
+    }
+
+    PrepareFn prepare_;
+    const char* op_;
+    std::string label_; // for log messages
+    std::unique_ptr<grpc::ClientAsyncReader<scene::Chunk>> reader_;
+    scene::Chunk chunk_;
+    grpc::Status status_;
+    State state_ = State::STARTING;
+
+    int64_t total_bytes_ = 0;
+    std::string data_;
+    std::function<void(int64_t, int64_t)> progress_cb_;
+    DownloadDoneCallback done_cb_;
+    bool keep_partial_ = false;
+    bool cancelled_ = false;
+};
+
+// Async unary manifest fetch: a single Finish completion.
+class SceneClient::AsyncManifestCall final : public SceneClient::AsyncCall {
+public:
+    AsyncManifestCall(scene::SceneRequest req, ManifestDoneCallback done_cb, std::shared_ptr<CancelToken> cancel)
+        : AsyncCall(std::move(cancel)), req_(std::move(req)), done_cb_(std::move(done_cb)) {}
+
+    void Start(scene::SceneService::Stub* stub, grpc::CompletionQueue* cq) override {
+        reader_ = stub->PrepareAsyncGetSceneManifest(&ctx_, req_, cq);
+        reader_->StartCall();
+        reader_->Finish(&manifest_, &status_, this);
+    }
+
+    bool Proceed(bool /*ok*/) override {
+        bool success = status_.ok() && !CancelRequested();
+        if (!status_.ok() && status_.error_code() != grpc::StatusCode::CANCELLED) {
+            std::cerr << "GetSceneManifestAsync failed: " << status_.error_message() << "\n";
+        }
+        if (done_cb_) done_cb_(success, std::move(manifest_));
+        return true;
+    }
+
+    void Abandon() override {
+        if (done_cb_) done_cb_(false, scene::SceneManifest());
+    }
+
+private:
+    scene::SceneRequest req_;
+    std::unique_ptr<grpc::ClientAsyncResponseReader<scene::SceneManifest>> reader_;
+    scene::SceneManifest manifest_;
+    grpc::Status status_;
+    ManifestDoneCallback done_cb_;
+};
+
+class SceneClient::ChannelLease {
+public:
+    explicit ChannelLease(SceneClient* client) : client_(client) {
+        std::scoped_lock lk(client_->calls_mtx_);
+        index_ = client_->AcquireChannelLocked();
+    }
+    ~ChannelLease() { client_->ReleaseChannel(index_); }
+    ChannelLease(const ChannelLease&) = delete;
+    ChannelLease& operator=(const ChannelLease&) = delete;
+    scene::SceneService::Stub* Stub() const { return client_->channels_[index_].stub.get(); }
+
+private:
+    SceneClient* client_;
+    size_t index_ = 0;
+};
+
+// Thin wrapper around gRPC stubs. Synchronous calls are used for manifests; model downloads
+// go through the async path driven by a small pool of completion-queue threads.
+SceneClient::SceneClient(std::shared_ptr<grpc::Channel> channel, size_t io_thread_count)
+    : SceneClient(std::vector<std::shared_ptr<grpc::Channel>>{ std::move(channel) }, io_thread_count) {}
+
+SceneClient::SceneClient(std::vector<std::shared_ptr<grpc::Channel>> channels, size_t io_thread_count) {
+    channels_.reserve(channels.size());
+    for (auto& ch : channels) {
+        PooledChannel pc;
+        pc.stub = scene::SceneService::NewStub(ch);
+        pc.channel = std::move(ch);
+        channels_.push_back(std::move(pc));
+    }
+    if (io_thread_count == 0) io_thread_count = 1;
+    for (size_t i = 0; i < io_thread_count; ++i) {
+        cq_threads_.emplace_back(&SceneClient::CompletionQueueThread, this);
+    }
+}
+
+SceneClient::~SceneClient() {
+    Shutdown();
+}
+
+std::vector<std::shared_ptr<grpc::Channel>> SceneClient::CreateChannelPool(const std::string& server_addr, size_t count) {
+    if (count == 0) count = 1;
+    std::vector<std::shared_ptr<grpc::Channel>> channels;
+    channels.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        grpc::ChannelArguments args;
+        // Without a channel-local pool, channels with equal args share one subchannel (one connection).
+        args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+        args.SetInt("p4.channel_index", static_cast<int>(i));
+        channels.push_back(grpc::CreateCustomChannel(server_addr, grpc::InsecureChannelCredentials(), args));
+    }
+    return channels;
+}
+
+size_t SceneClient::WarmUp(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::system_clock::now() + timeout;
+    // Kick off every connection first so the handshakes overlap, then wait on each.
+    for (auto& pc : channels_) pc.channel->GetState(true);
+    size_t ready = 0;
+    for (auto& pc : channels_) {
+        if (pc.channel->WaitForConnected(deadline)) ++ready;
+    }
+    std::cerr << "[SceneClient] " << ready << "/" << channels_.size() << " channels connected\n";
+    return ready;
+}
+
+void SceneClient::SetDeadlines(const RpcDeadlines& deadlines) {
+    std::scoped_lock lk(deadlines_mtx_);
+    deadlines_ = deadlines;
+}
+
+RpcDeadlines SceneClient::Deadlines() const {
+    std::scoped_lock lk(deadlines_mtx_);
+    return deadlines_;
+}
+
+std::chrono::milliseconds SceneClient::ManifestTimeout() const {
+    std::scoped_lock lk(deadlines_mtx_);
+    return deadlines_.manifest;
+}
+
+std::chrono::milliseconds SceneClient::BatchManifestTimeout(size_t scene_count) const {
+    std::scoped_lock lk(deadlines_mtx_);
+    if (deadlines_.manifest.count() <= 0) return std::chrono::milliseconds(0);
+    return deadlines_.manifest + deadlines_.manifest_batch_per_scene * static_cast<int64_t>(scene_count);
+}
+
+std::chrono::milliseconds SceneClient::StreamTimeout(int64_t total_bytes) const {
+    std::scoped_lock lk(deadlines_mtx_);
+    if (deadlines_.model_stream_base.count() <= 0) return std::chrono::milliseconds(0);
+    double mib = total_bytes > 0 ? static_cast<double>(total_bytes) / (1024.0 * 1024.0) : 0.0;
+    auto extra = std::chrono::milliseconds(static_cast<int64_t>(mib * static_cast<double>(deadlines_.model_stream_per_mib.count())));
+    return deadlines_.model_stream_base + extra;
+}
+
+size_t SceneClient::AcquireChannelLocked() {
+    // Scan from the round-robin cursor so ties rotate instead of piling onto channel 0.
+    size_t best = 0;
+    bool best_failing = true;
+    for (size_t k = 0; k < channels_.size(); ++k) {
+        size_t i = (next_channel_ + k) % channels_.size();
+        bool failing = channels_[i].channel->GetState(false) == GRPC_CHANNEL_TRANSIENT_FAILURE;
+        bool better = k == 0 || (best_failing && !failing) ||
+                      (failing == best_failing && channels_[i].in_flight < channels_[best].in_flight);
+        if (better) {
+            best = i;
+            best_failing = failing;
+        }
+    }
+    next_channel_ = (best + 1) % channels_.size();
+    ++channels_[best].in_flight;
+    return best;
+}
 
-// Thin wrapper around gRPC stub for synchronous calls used by the client UI.
-SceneClient::SceneClient(std::shared_ptr<grpc::Channel> channel)
-    : stub_(scene::SceneService::NewStub(channel)) {
+void SceneClient::ReleaseChannel(size_t index) {
+    std::scoped_lock lk(calls_mtx_);
+    --channels_[index].in_flight;
 }
 
 // GetSceneManifest: synchronous RPC, returns false on error.
 bool SceneClient::GetSceneManifest(const std::string& scene_id, scene::SceneManifest& out_manifest) {
     grpc::ClientContext ctx;
+    ApplyTimeout(ctx, ManifestTimeout());
     scene::SceneRequest req;
     req.set_scene_id(scene_id);
-    grpc::Status status = stub_->GetSceneManifest(&ctx, req, &out_manifest);
+    ChannelLease lease(this);
+    grpc::Status status = lease.Stub()->GetSceneManifest(&ctx, req, &out_manifest);
     if (!status.ok()) {
         std::cerr << "GetSceneManifest failed: " << status.error_message() << "\n";
         return false;
@@ -25,79 +323,231 @@ bool SceneClient::GetSceneManifest(const std::string& scene_id, scene::SceneMani
     return true;
 }
 
-// StreamModelToFile: streams model data to disk; calls progress_cb during download.
-// Accepts optional cancel token pointer; if non-null and *cancel is true the download will abort.
-bool SceneClient::StreamModelToFile(const std::string& scene_id,
-                                    const std::string& rel_path,
-                                    const std::string& out_path,
-                                    int64_t total_bytes,
-                                    std::function<void(int64_t, int64_t)> progress_cb,
-                                    std::atomic<bool>* cancel) {
+// GetSceneManifests: one server stream for many scenes instead of a round trip per scene.
+bool SceneClient::GetSceneManifests(const std::vector<std::string>& scene_ids,
+                                    const BatchManifestCallback& on_manifest,
+                                    const std::shared_ptr<CancelToken>& cancel) {
+    if (scene_ids.empty()) return true;
+    if (cancel && cancel->IsCancelled()) return false;
+
+    grpc::ClientContext ctx;
+    ApplyTimeout(ctx, BatchManifestTimeout(scene_ids.size()));
+    scene::SceneManifestsRequest req;
+    for (const auto& id : scene_ids) req.add_scene_ids(id);
+
+    size_t received = 0;
+    grpc::Status status;
+    {
+        SyncCallCanceller canceller(ctx, cancel);
+        ChannelLease lease(this);
+        std::unique_ptr<grpc::ClientReader<scene::SceneManifestResult>> reader(lease.Stub()->GetSceneManifests(&ctx, req));
+        scene::SceneManifestResult result;
+        while (reader->Read(&result)) {
+            ++received;
+            if (on_manifest) on_manifest(result.scene_id(), result.found(), std::move(*result.mutable_manifest()));
+            result.Clear();
+        }
+        status = reader->Finish();
+    }
+
+    if (cancel && cancel->IsCancelled()) return false;
+    if (!status.ok()) {
+        std::cerr << "GetSceneManifests failed after " << received << "/" << scene_ids.size()
+                  << " manifests: " << status.error_message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool SceneClient::ListScenes(const std::string& page_token, int32_t page_size, scene::ListScenesResponse& out) {
+    grpc::ClientContext ctx;
+    ApplyTimeout(ctx, ManifestTimeout());
+    scene::ListScenesRequest req;
+    req.set_page_token(page_token);
+    req.set_page_size(page_size);
+    ChannelLease lease(this);
+    grpc::Status status = lease.Stub()->ListScenes(&ctx, req, &out);
+    if (!status.ok()) {
+        std::cerr << "ListScenes failed: " << status.error_message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+// WatchScenes: long-lived server stream, read synchronously on the caller's thread.
+bool SceneClient::WatchScenes(int64_t since_version,
+                              const std::function<void(const scene::SceneChange&)>& on_change,
+                              const std::shared_ptr<CancelToken>& cancel) {
+    if (cancel && cancel->IsCancelled()) return true;
+
     grpc::ClientContext ctx;
+    scene::WatchScenesRequest req;
+    req.set_since_version(since_version);
+    grpc::Status status;
+    {
+        SyncCallCanceller canceller(ctx, cancel);
+        ChannelLease lease(this);
+        std::unique_ptr<grpc::ClientReader<scene::SceneChange>> reader(lease.Stub()->WatchScenes(&ctx, req));
+        scene::SceneChange change;
+        while (reader->Read(&change)) {
+            if (on_change) on_change(change);
+        }
+        status = reader->Finish();
+    }
+
+    if (cancel && cancel->IsCancelled()) return true;
+    if (!status.ok()) {
+        std::cerr << "WatchScenes failed: " << status.error_message() << "\n";
+        return false;
+    }
+    return true;
+}
+
+// StreamModelAsync: registers a new call and starts it on the shared completion queue.
+void SceneClient::StreamModelAsync(const std::string& scene_id,
+                                   const std::string& rel_path,
+                                   int64_t total_bytes,
+                                   std::function<void(int64_t, int64_t)> progress_cb,
+                                   DownloadDoneCallback done_cb,
+                                   std::shared_ptr<CancelToken> cancel,
+                                   const std::string& content_hash) {
+    if (cancel && cancel->IsCancelled()) {
+        std::cerr << "StreamModelAsync: cancel requested before start for " << rel_path << "\n";
+        if (done_cb) done_cb(false, std::string());
+        return;
+    }
+
     scene::ModelRequest req;
     req.set_scene_id(scene_id);
     req.set_model_rel_path(rel_path);
     req.set_offset(0);
+    req.set_content_hash(content_hash);
 
-    // quick cancellation check before starting
-    if (cancel && cancel->load()) {
-        std::cerr << "StreamModelToFile: cancel requested before start for " << rel_path << "\n";
-        return false;
+    auto prepare = [req = std::move(req)](scene::SceneService::Stub* stub, grpc::ClientContext* ctx, grpc::CompletionQueue* cq) {
+        return stub->PrepareAsyncStreamModel(ctx, req, cq);
+    };
+    auto* call = new AsyncChunkCall(std::move(prepare), "StreamModelAsync", rel_path, total_bytes, std::move(progress_cb), std::move(done_cb), std::move(cancel));
+    call->SetTimeout(StreamTimeout(total_bytes));
+    if (!StartCall(call)) {
+        std::cerr << "StreamModelAsync: client is shut down, dropping " << rel_path << "\n";
+        call->Abandon();
+        delete call;
     }
+}
 
-    std::unique_ptr<grpc::ClientReader<scene::Chunk>> reader(stub_->StreamModel(&ctx, req));
-    std::ofstream ofs(out_path, std::ios::binary | std::ios::trunc);
-    if (!ofs) {
-        std::cerr << "Failed to open output file: " << out_path << "\n";
-        return false;
+void SceneClient::StreamScenePackAsync(const std::string& scene_id,
+                                       const std::string& pack_id,
+                                       int64_t offset,
+                                       int64_t expected_bytes,
+                                       std::function<void(int64_t, int64_t)> progress_cb,
+                                       DownloadDoneCallback done_cb,
+                                       std::shared_ptr<CancelToken> cancel) {
+    if (cancel && cancel->IsCancelled()) {
+        if (done_cb) done_cb(false, std::string());
+        return;
     }
 
-    scene::Chunk chunk;
-    int64_t bytes_written = 0;
-    bool cancelled = false;
-    while (reader->Read(&chunk)) {
-        // check cancellation periodically
-        if (cancel && cancel->load()) {
-            std::cerr << "StreamModelToFile: cancellation detected for " << rel_path << "\n";
-            // ask gRPC to cancel the RPC (best-effort)
-            ctx.TryCancel();
-            cancelled = true;
-            break;
-        }
+    scene::ScenePackRequest req;
+    req.set_scene_id(scene_id);
+    req.set_pack_id(pack_id);
+    req.set_offset(offset);
 
-        if (chunk.data().size() > 0) {
-            ofs.write(chunk.data().data(), static_cast<std::streamsize>(chunk.data().size()));
-            bytes_written += static_cast<int64_t>(chunk.data().size());
-            if (progress_cb) progress_cb(bytes_written, total_bytes);
-        }
-        if (chunk.last()) {
-            break;
-        }
+    auto prepare = [req = std::move(req)](scene::SceneService::Stub* stub, grpc::ClientContext* ctx, grpc::CompletionQueue* cq) {
+        return stub->PrepareAsyncStreamScenePack(ctx, req, cq);
+    };
+    auto* call = new AsyncChunkCall(std::move(prepare), "StreamScenePackAsync", scene_id + " pack " + pack_id, 0, std::move(progress_cb), std::move(done_cb),
+                                    std::move(cancel), /*keep_partial=*/true);
+    call->SetTimeout(StreamTimeout(expected_bytes));
+    if (!StartCall(call)) {
+        std::cerr << "StreamScenePackAsync: client is shut down, dropping " << scene_id << "\n";
+        call->Abandon();
+        delete call;
     }
+}
 
-    grpc::Status status = reader->Finish();
+void SceneClient::GetSceneManifestAsync(const std::string& scene_id, ManifestDoneCallback done_cb,
+                                        std::shared_ptr<CancelToken> cancel) {
+    if (cancel && cancel->IsCancelled()) {
+        if (done_cb) done_cb(false, scene::SceneManifest());
+        return;
+    }
 
-    ofs.close();
+    scene::SceneRequest req;
+    req.set_scene_id(scene_id);
 
-    if (cancelled) {
-        // remove partial file to avoid leaving corrupted artifacts
-        try {
-            if (fs::exists(out_path)) fs::remove(out_path);
-        } catch (...) {
-            std::cerr << "StreamModelToFile: failed to remove partial file " << out_path << "\n";
-        }
-        return false;
+    auto* call = new AsyncManifestCall(std::move(req), std::move(done_cb), std::move(cancel));
+    call->SetTimeout(ManifestTimeout());
+    if (!StartCall(call)) {
+        std::cerr << "GetSceneManifestAsync: client is shut down, dropping " << scene_id << "\n";
+        call->Abandon();
+        delete call;
     }
+}
 
-    if (!status.ok()) {
-        std::cerr << "StreamModel failed: " << status.error_message() << "\n";
-        // on RPC error remove partial file
-        try {
-            if (fs::exists(out_path)) fs::remove(out_path);
-        } catch (...) {
-            std::cerr << "StreamModelToFile: failed to remove partial file after error " << out_path << "\n";
+bool SceneClient::StartCall(AsyncCall* call) {
+    // Register before the call is visible so a cancel can never slip between start and registration;
+    // CancelCall ignores ids that aren't (or are no longer) in calls_. The callback holds the id, not
+    // the pointer: it may still run after the call finished and another took its address.
+    call->id_ = next_call_id_.fetch_add(1);
+    if (call->cancel_) {
+        call->cancel_cb_ = call->cancel_->OnCancel([this, id = call->id_]() { CancelCall(id); });
+    }
+    {
+        // Hold the lock while starting so Shutdown cannot close the queue underneath us.
+        std::scoped_lock lk(calls_mtx_);
+        if (!shut_down_.load()) {
+            calls_.emplace(call->id_, call);
+            call->channel_ = AcquireChannelLocked();
+            call->Start(channels_[call->channel_].stub.get(), &cq_);
+            // Covers a cancel that ran its callback before the insert above.
+            if (call->CancelRequested()) call->Cancel();
+            return true;
         }
-        return false;
     }
-    return true;
+    if (call->cancel_) call->cancel_->Unregister(call->cancel_cb_);
+    return false;
+}
+
+void SceneClient::CancelCall(uint64_t id) {
+    std::scoped_lock lk(calls_mtx_);
+    auto it = calls_.find(id);
+    if (it != calls_.end()) it->second->Cancel();
+}
+
+void SceneClient::CancelAsyncStreams() {
+    std::unique_lock lk(calls_mtx_);
+    for (auto& [id, call] : calls_) call->Cancel();
+    calls_cv_.wait(lk, [&]() { return calls_.empty(); });
+}
+
+void SceneClient::Shutdown() {
+    {
+        std::scoped_lock lk(calls_mtx_);
+        if (shut_down_.exchange(true)) return;
+    }
+    CancelAsyncStreams();
+    cq_.Shutdown();
+    for (auto& t : cq_threads_) if (t.joinable()) t.join();
+    cq_threads_.clear();
+}
+
+// Drains the completion queue; each tag is the AsyncCall that owns the finished operation.
+void SceneClient::CompletionQueueThread() {
+    void* tag = nullptr;
+    bool ok = false;
+    while (cq_.Next(&tag, &ok)) {
+        auto* call = static_cast<AsyncCall*>(tag);
+        if (call->Proceed(ok)) OnCallFinished(call);
+    }
+}
+
+void SceneClient::OnCallFinished(AsyncCall* call) {
+    {
+        std::scoped_lock lk(calls_mtx_);
+        calls_.erase(call->id_);
+        --channels_[call->channel_].in_flight;
+    }
+    if (call->cancel_) call->cancel_->Unregister(call->cancel_cb_);
+    delete call;
+    calls_cv_.notify_all();
 }
\ No newline at end of file
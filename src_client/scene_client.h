@@ -1,27 +1,225 @@
 #pragma once
 
 #include "sceneloader.grpc.pb.h"
+#include "cancel_token.h"
 #include <grpcpp/grpcpp.h>
 #include <functional>
 #include <string>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <coroutine>
+#include <chrono>
+
+struct DownloadResult {
+    bool ok = false;
+    std::string data;
+};
+
+struct ManifestResult {
+    bool ok = false;
+    scene::SceneManifest manifest;
+};
+
+// Per-operation RPC deadlines; zero disables the deadline for that operation. The server stops
+// work for a call as soon as its deadline passes.
+struct RpcDeadlines {
+    std::chrono::milliseconds manifest{ 15000 };
+    // Batched manifests get manifest + per_scene * scene count.
+    std::chrono::milliseconds manifest_batch_per_scene{ 250 };
+    // Model streams get base + per_mib * size, since transfer time grows with the file.
+    std::chrono::milliseconds model_stream_base{ 30000 };
+    std::chrono::milliseconds model_stream_per_mib{ 2000 };
+};
 
 class SceneClient {
 public:
-    SceneClient(std::shared_ptr<grpc::Channel> channel);
+    // Completion callback for async downloads. ok=false on RPC error or cancellation.
+    // data holds the whole model file on success.
+    using DownloadDoneCallback = std::function<void(bool ok, std::string data)>;
+    using ManifestDoneCallback = std::function<void(bool ok, scene::SceneManifest manifest)>;
+    // found=false if the server has no such scene (manifest is empty then).
+    using BatchManifestCallback = std::function<void(const std::string& scene_id, bool found, scene::SceneManifest manifest)>;
+
+    // io_thread_count: number of threads draining the completion queue for async streams.
+    SceneClient(std::shared_ptr<grpc::Channel> channel, size_t io_thread_count = 1);
+    // Pool of channels (see CreateChannelPool). Every call goes to the channel with the fewest
+    // calls in flight, so concurrent downloads spread over several TCP connections.
+    SceneClient(std::vector<std::shared_ptr<grpc::Channel>> channels, size_t io_thread_count = 1);
+    ~SceneClient();
+
+    // `count` channels to one server, each with its own TCP connection: the channel args differ per
+    // channel and the subchannel pool is channel-local, so gRPC can't share a connection between them.
+    static std::vector<std::shared_ptr<grpc::Channel>> CreateChannelPool(const std::string& server_addr, size_t count);
+
+    // Applies to calls started afterwards. Thread-safe.
+    void SetDeadlines(const RpcDeadlines& deadlines);
+    RpcDeadlines Deadlines() const;
+
+    // Start connecting every channel and wait up to `timeout` for them to become ready, so the first
+    // manifest call doesn't pay for the handshakes. Returns the number of ready channels.
+    size_t WarmUp(std::chrono::milliseconds timeout);
 
     // Returns scene manifest (synchronous)
     bool GetSceneManifest(const std::string& scene_id, scene::SceneManifest& out_manifest);
 
-    // Streams model to disk. progress_cb(bytes_received, total_bytes)
-    // Added optional cancel token pointer. If non-null, StreamModelToFile should abort early when *cancel is true.
-    bool StreamModelToFile(const std::string& scene_id,
-                           const std::string& rel_path,
-                           const std::string& out_path,
-                           int64_t total_bytes,
-                           std::function<void(int64_t, int64_t)> progress_cb,
-                           std::atomic<bool>* cancel = nullptr);
+    // Manifests of many scenes in one round trip (synchronous). on_manifest runs on the calling
+    // thread as each manifest arrives, in request order. Returns false if the stream failed or
+    // was cancelled; manifests delivered before that stay valid.
+    bool GetSceneManifests(const std::vector<std::string>& scene_ids,
+                           const BatchManifestCallback& on_manifest,
+                           const std::shared_ptr<CancelToken>& cancel = nullptr);
+
+    // One page of the server's scene catalog (synchronous). page_size 0 = server default.
+    bool ListScenes(const std::string& page_token, int32_t page_size, scene::ListScenesResponse& out);
+
+    // Blocks while the server pushes catalog changes after since_version; on_change runs on the
+    // calling thread for each one. Has no deadline: cancelling `cancel` ends the stream. Returns
+    // false if the stream failed for any other reason.
+    bool WatchScenes(int64_t since_version,
+                     const std::function<void(const scene::SceneChange&)>& on_change,
+                     const std::shared_ptr<CancelToken>& cancel);
+
+    // Starts an async download of a model into memory and returns immediately.
+    // The stream is driven by the completion-queue threads; progress_cb and done_cb run on those threads,
+    // so they must be cheap (hand the buffer off to a worker instead of parsing in place).
+    // Cancelling `cancel` aborts the stream right away (TryCancel), not at the next chunk.
+    // With a content_hash the blob is requested by hash instead of by scene path.
+    void StreamModelAsync(const std::string& scene_id,
+                          const std::string& rel_path,
+                          int64_t total_bytes,
+                          std::function<void(int64_t, int64_t)> progress_cb,
+                          DownloadDoneCallback done_cb,
+                          std::shared_ptr<CancelToken> cancel = nullptr,
+                          const std::string& content_hash = std::string());
+
+    // Starts an async download of a scene's pack (see SceneManifest.pack_id) from byte `offset`
+    // to its end. progress_cb gets (bytes of this range received, whole pack size). On failure
+    // done_cb still gets the bytes received so far, so a later call can resume after them.
+    // expected_bytes only sizes the deadline.
+    void StreamScenePackAsync(const std::string& scene_id,
+                              const std::string& pack_id,
+                              int64_t offset,
+                              int64_t expected_bytes,
+                              std::function<void(int64_t, int64_t)> progress_cb,
+                              DownloadDoneCallback done_cb,
+                              std::shared_ptr<CancelToken> cancel = nullptr);
+
+    // Async variant of GetSceneManifest, completed on a completion-queue thread.
+    void GetSceneManifestAsync(const std::string& scene_id, ManifestDoneCallback done_cb,
+                               std::shared_ptr<CancelToken> cancel = nullptr);
+
+    // Awaitable adapters for coroutine loaders. Both resume the awaiting coroutine on a
+    // completion-queue thread; hop to a worker before doing anything heavy.
+    class DownloadAwaiter {
+    public:
+        // start(done) begins the download and eventually calls done exactly once.
+        explicit DownloadAwaiter(std::function<void(DownloadDoneCallback)> start) : start_(std::move(start)) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            start_([this, h](bool ok, std::string data) {
+                result_.ok = ok;
+                result_.data = std::move(data);
+                h.resume();
+            });
+        }
+        DownloadResult await_resume() { return std::move(result_); }
+
+    private:
+        std::function<void(DownloadDoneCallback)> start_;
+        DownloadResult result_;
+    };
+
+    class ManifestAwaiter {
+    public:
+        ManifestAwaiter(SceneClient* client, std::string scene_id, std::shared_ptr<CancelToken> cancel)
+            : client_(client), scene_id_(std::move(scene_id)), cancel_(std::move(cancel)) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            client_->GetSceneManifestAsync(scene_id_, [this, h](bool ok, scene::SceneManifest manifest) {
+                result_.ok = ok;
+                result_.manifest = std::move(manifest);
+                h.resume();
+            }, cancel_);
+        }
+        ManifestResult await_resume() { return std::move(result_); }
+
+    private:
+        SceneClient* client_;
+        std::string scene_id_;
+        std::shared_ptr<CancelToken> cancel_;
+        ManifestResult result_;
+    };
+
+    DownloadAwaiter DownloadModel(const std::string& scene_id, const std::string& rel_path, int64_t total_bytes,
+                                  std::function<void(int64_t, int64_t)> progress_cb, std::shared_ptr<CancelToken> cancel = nullptr,
+                                  std::string content_hash = std::string()) {
+        return DownloadAwaiter([=, this, progress_cb = std::move(progress_cb), cancel = std::move(cancel),
+                                content_hash = std::move(content_hash)](DownloadDoneCallback done) mutable {
+            StreamModelAsync(scene_id, rel_path, total_bytes, std::move(progress_cb), std::move(done), cancel, content_hash);
+        });
+    }
+    // Result data is the pack from `offset` on; on failure, the part received before the error.
+    DownloadAwaiter DownloadPack(const std::string& scene_id, const std::string& pack_id, int64_t offset, int64_t expected_bytes,
+                                 std::function<void(int64_t, int64_t)> progress_cb, std::shared_ptr<CancelToken> cancel = nullptr) {
+        return DownloadAwaiter([=, this, progress_cb = std::move(progress_cb), cancel = std::move(cancel)](DownloadDoneCallback done) mutable {
+            StreamScenePackAsync(scene_id, pack_id, offset, expected_bytes, std::move(progress_cb), std::move(done), cancel);
+        });
+    }
+    ManifestAwaiter FetchManifest(const std::string& scene_id, std::shared_ptr<CancelToken> cancel = nullptr) {
+        return ManifestAwaiter(this, scene_id, std::move(cancel));
+    }
+
+    // Best-effort cancel of every in-flight async stream, then wait until all of them have reported done.
+    void CancelAsyncStreams();
+
+    // Stop the completion-queue threads (pending streams are cancelled first).
+    void Shutdown();
 
 private:
-    std::unique_ptr<scene::SceneService::Stub> stub_;
+    class AsyncCall;
+    class AsyncChunkCall;
+    class AsyncManifestCall;
+
+    struct PooledChannel {
+        std::shared_ptr<grpc::Channel> channel;
+        std::unique_ptr<scene::SceneService::Stub> stub;
+        size_t in_flight = 0; // guarded by calls_mtx_
+    };
+
+    // Least-loaded channel (channels in TRANSIENT_FAILURE only if nothing else is usable); its
+    // in_flight count is incremented and must be handed back with ReleaseChannel. Needs calls_mtx_.
+    size_t AcquireChannelLocked();
+    void ReleaseChannel(size_t index);
+    // Holds a channel for the duration of a synchronous call.
+    class ChannelLease;
+
+    std::chrono::milliseconds ManifestTimeout() const;
+    std::chrono::milliseconds BatchManifestTimeout(size_t scene_count) const;
+    std::chrono::milliseconds StreamTimeout(int64_t total_bytes) const;
+
+    // Registers and starts a call unless the client is shut down. On false the caller still owns it.
+    bool StartCall(AsyncCall* call);
+    // TryCancel a call if it is still registered (invoked from cancel-token callbacks).
+    void CancelCall(uint64_t id);
+    void CompletionQueueThread();
+    void OnCallFinished(AsyncCall* call);
+
+    std::vector<PooledChannel> channels_;
+    size_t next_channel_ = 0; // round-robin tie-break, guarded by calls_mtx_
+
+    grpc::CompletionQueue cq_;
+    std::vector<std::thread> cq_threads_;
+    std::atomic<bool> shut_down_{ false };
+
+    mutable std::mutex deadlines_mtx_;
+    RpcDeadlines deadlines_;
+
+    std::mutex calls_mtx_;
+    std::condition_variable calls_cv_;
+    std::unordered_map<uint64_t, AsyncCall*> calls_; // by AsyncCall id
+    std::atomic<uint64_t> next_call_id_{ 1 };
 };
\ No newline at end of file
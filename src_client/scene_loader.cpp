@@ -1,19 +1,98 @@
 #include "scene_loader.h"
 #include "model_loader.h"
+#include "render_world.h"
+#include "mesh_registry.h"
+#include "mesh_buffer_pool.h"
+#include "gl_upload_thread.h"
 #include "tiny_obj_loader.h"
+#include "sha256.h"
+#include "scene_pack.h"
+#include "cooked_mesh.h"
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
-#include <cfloat>
+#include <chrono>
 #include <glm/glm.hpp>
 
 namespace fs = std::filesystem;
 
-SceneLoader::SceneLoader(SceneClient* client, GLRenderer* renderer, std::queue<GLUploadTask>& upload_queue, std::mutex& upload_mtx, std::condition_variable& upload_cv, const std::string& tmp_dir, size_t worker_count)
-    : client_(client), renderer_(renderer), tmp_dir_(tmp_dir), upload_queue_(upload_queue), upload_mtx_(upload_mtx), upload_cv_(upload_cv), worker_count_(worker_count) {
+// Centered, unit-size model matrix for a mesh (scale first, then translate: p' = scale * (p - center))
+// and its bounds after that transform.
+static void NormalizeModel(const MeshStats& stats, glm::mat4& model_matrix, ModelBounds& bounds) {
+    glm::vec3 minv(stats.aabb_min[0], stats.aabb_min[1], stats.aabb_min[2]);
+    glm::vec3 maxv(stats.aabb_max[0], stats.aabb_max[1], stats.aabb_max[2]);
+    glm::vec3 center = (minv + maxv) * 0.5f;
+    glm::vec3 extent = maxv - minv;
+    float max_extent = std::max(std::max(extent.x, extent.y), extent.z);
+    float scale = (max_extent > 0.0f) ? (1.0f / max_extent) : 1.0f;
+
+    glm::mat4 T = glm::mat4(1.0f);
+    T[3] = glm::vec4(-center, 1.0f);
+    glm::mat4 S = glm::mat4(1.0f);
+    S[0][0] = scale; S[1][1] = scale; S[2][2] = scale;
+    model_matrix = S * T;
+
+    glm::vec3 sc(stats.sphere_center[0], stats.sphere_center[1], stats.sphere_center[2]);
+    bounds = { glm::vec3(model_matrix * glm::vec4(sc, 1.0f)), stats.sphere_radius * scale };
+}
+
+static MeshStats StatsFromManifest(const scene::Bounds& b, int64_t triangle_count) {
+    MeshStats stats;
+    const scene::Vec3* src[3] = { &b.aabb_min(), &b.aabb_max(), &b.sphere_center() };
+    float* dst[3] = { stats.aabb_min, stats.aabb_max, stats.sphere_center };
+    for (int k = 0; k < 3; ++k) {
+        dst[k][0] = src[k]->x();
+        dst[k][1] = src[k]->y();
+        dst[k][2] = src[k]->z();
+    }
+    stats.sphere_radius = b.sphere_radius();
+    stats.triangle_count = static_cast<uint64_t>(triangle_count);
+    return stats;
+}
+
+// Reads a cached blob. Blobs are only written whole (WriteFileOn renames them into place), but the
+// hash is still checked, since it may key a mesh shared by every scene; a bad blob is deleted.
+static bool ReadCachedBlob(const fs::path& path, int64_t expected_size, const std::string& content_hash, std::string& out) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec || (expected_size > 0 && size != static_cast<uintmax_t>(expected_size))) return false;
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) return false;
+    out.resize(static_cast<size_t>(size));
+    ifs.read(out.data(), static_cast<std::streamsize>(size));
+    if (!ifs) {
+        out.clear();
+        return false;
+    }
+    ifs.close();
+    if (Sha256::HexDigest(out) != content_hash) {
+        std::cerr << "[SceneLoader] Cached blob " << path << " doesn't match its hash; fetching again\n";
+        out.clear();
+        fs::remove(path, ec);
+        return false;
+    }
+    return true;
+}
+
+// Appends a received pack range to its .part file; false if nothing could be kept.
+static bool AppendPart(const fs::path& path, const std::string& data) {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    std::ofstream ofs(path, std::ios::binary | std::ios::app);
+    if (!ofs) return false;
+    ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(ofs);
+}
+
+SceneLoader::SceneLoader(SceneClient* client, MeshRegistry* meshes, std::queue<GLUploadTask>& upload_queue, std::mutex& upload_mtx, std::condition_variable& upload_cv, const std::string& tmp_dir, size_t worker_count, size_t max_inflight_downloads)
+    : client_(client), meshes_(meshes), tmp_dir_(tmp_dir), worker_count_(ResolveWorkerCount(worker_count)),
+      // Start downloads modestly and let measured latency open them up; parsing starts at one per worker.
+      download_limiter_("downloads", 8, 2, max_inflight_downloads == 0 ? 1 : max_inflight_downloads),
+      parse_limiter_("parse", worker_count_, 1, worker_count_),
+      download_slots_(download_limiter_.Limit()), parse_slots_(parse_limiter_.Limit()),
+      upload_queue_(upload_queue), upload_mtx_(upload_mtx), upload_cv_(upload_cv) {
     fs::create_directories(tmp_dir_);
-    if (worker_count_ == 0) worker_count_ = 1;
     for (size_t i = 0; i < worker_count_; ++i) {
         workers_.emplace_back(&SceneLoader::WorkerThread, this);
     }
@@ -23,170 +102,528 @@ SceneLoader::~SceneLoader() {
     Shutdown();
 }
 
-void SceneLoader::EnqueueLoad(const std::shared_ptr<SceneDescriptor>& scene) {
+size_t SceneLoader::ResolveWorkerCount(size_t requested) {
+    if (requested > 0) return requested;
+    size_t hw = std::thread::hardware_concurrency();
+    // Leave a core for the render thread; hardware_concurrency may report 0.
+    return hw > 2 ? hw - 1 : 2;
+}
+
+bool SceneLoader::EnqueueLoad(const std::shared_ptr<SceneDescriptor>& scene) {
+    // The previous load's coroutines still reference scene->models until they unwind.
+    if (scene->load_active.exchange(true)) return false;
+    auto token = CancelToken::Create(shutdown_token_);
     {
-        std::scoped_lock lk(queue_mtx_);
-        queue_.push_back(scene);
-        scene->state.store(SceneState::QUEUED);
+        std::scoped_lock lk(scene->mtx);
+        scene->load_token = token;
     }
-    queue_cv_.notify_one();
+    scene->state.store(SceneState::QUEUED);
+    // The coroutine immediately hops onto a worker, so this returns without blocking.
+    LoadScene(scene, std::move(token));
+    return true;
+}
+
+void SceneLoader::CancelLoad(const std::shared_ptr<SceneDescriptor>& scene) {
+    std::shared_ptr<CancelToken> token;
+    {
+        std::scoped_lock lk(scene->mtx);
+        token = scene->load_token;
+    }
+    // Cancel outside the lock; callbacks reach into SceneClient.
+    if (token) token->Cancel();
+}
+
+void SceneLoader::CancelModel(const std::shared_ptr<SceneDescriptor>& scene, size_t model_index) {
+    std::shared_ptr<CancelToken> token;
+    {
+        std::scoped_lock lk(scene->mtx);
+        if (model_index < scene->models.size()) token = scene->models[model_index].cancel;
+    }
+    if (token) token->Cancel();
+}
+
+void SceneLoader::PrefetchManifests(const std::vector<std::string>& scene_ids) {
+    auto start = std::chrono::steady_clock::now();
+    size_t stored = 0;
+    client_->GetSceneManifests(scene_ids, [&](const std::string& scene_id, bool found, scene::SceneManifest manifest) {
+        if (!found) return;
+        std::scoped_lock lk(manifests_mtx_);
+        // A load that fetched its own copy meanwhile is at least as fresh.
+        if (manifests_.emplace(scene_id, std::move(manifest)).second) ++stored;
+    }, shutdown_token_);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[SceneLoader] Prefetched " << stored << "/" << scene_ids.size() << " manifests in " << ms << " ms\n";
+}
+
+void SceneLoader::InvalidateManifest(const std::string& scene_id) {
+    std::scoped_lock lk(manifests_mtx_);
+    manifests_.erase(scene_id);
 }
 
 void SceneLoader::Shutdown() {
-    // Request cancellation for any in-progress RPCs and stop queue processing.
-    cancel_requested_.store(true);
+    // Cancel every scene/model token (aborting in-progress RPCs) and stop queue processing.
+    shutdown_token_->Cancel();
     running_ = false;
+    // Fail loads still waiting for a download slot, then abort open streams and wait for
+    // their callbacks so no completion outlives the loader.
+    download_slots_.Close();
+    parse_slots_.Close();
+    client_->CancelAsyncStreams();
     queue_cv_.notify_all();
     // Wake any threads waiting on upload_cv (main thread drain may be waiting)
     upload_cv_.notify_all();
     for (auto& t : workers_) if (t.joinable()) t.join();
     workers_.clear();
+
+    // Resume whatever is still parked for a worker so cancelled loads unwind and free their frames.
+    while (true) {
+        std::coroutine_handle<> h;
+        {
+            std::scoped_lock lk(queue_mtx_);
+            if (ready_.empty()) break;
+            h = ready_.front();
+            ready_.pop_front();
+        }
+        h.resume();
+    }
+}
+
+void SceneLoader::WorkerExecutor::Post(std::coroutine_handle<> h) {
+    {
+        std::scoped_lock lk(owner_->queue_mtx_);
+        owner_->ready_.push_back(h);
+    }
+    owner_->queue_cv_.notify_one();
 }
 
+void SceneLoader::MainThreadExecutor::Post(std::coroutine_handle<> h) {
+    {
+        std::scoped_lock lk(owner_->upload_mtx_);
+        owner_->upload_queue_.push([h]() { h.resume(); });
+    }
+    owner_->upload_cv_.notify_one();
+}
+
+// Worker threads only resume coroutines; all blocking CPU/file work happens inside those.
 void SceneLoader::WorkerThread() {
-    ModelLoader model_loader;
     while (running_) {
-        std::shared_ptr<SceneDescriptor> scene;
+        std::coroutine_handle<> h;
         {
             std::unique_lock lk(queue_mtx_);
-            queue_cv_.wait(lk, [&]() { return !queue_.empty() || !running_; });
+            queue_cv_.wait(lk, [&]() { return !ready_.empty() || !running_; });
             if (!running_) break;
-            scene = queue_.front();
-            queue_.pop_front();
-            scene->state.store(SceneState::LOADING);
+            h = ready_.front();
+            ready_.pop_front();
         }
+        h.resume();
+    }
+}
 
-        // synchronous RPC to get manifest
-        scene::SceneManifest manifest;
-        if (!client_->GetSceneManifest(scene->scene_id, manifest)) {
-            scene->state.store(SceneState::ERROR_STATE);
-            continue;
+DetachedTask SceneLoader::LoadScene(std::shared_ptr<SceneDescriptor> scene, std::shared_ptr<CancelToken> cancel) {
+    // Clears load_active when the frame is destroyed, i.e. after every child task has finished.
+    // The last load to finish trims the mesh buffer pool back to the heap.
+    struct ActiveGuard {
+        SceneDescriptor* sd;
+        std::atomic<size_t>& active_loads;
+        ~ActiveGuard() {
+            sd->load_active.store(false);
+            if (active_loads.fetch_sub(1) == 1) MeshBufferPool::Instance().TrimIfUnused();
         }
+    } active_guard{ scene.get(), active_loads_ };
+    active_loads_.fetch_add(1);
 
-        // initialize per-model containers
-        {
-            std::scoped_lock lk(scene->mtx);
-            scene->models.clear();
-            scene->mesh_handles.clear();
-            scene->model_transforms.clear();
-            scene->model_bounds.clear();
-            scene->models.reserve(manifest.models_size());
-            scene->mesh_handles.resize(manifest.models_size());
-            scene->model_transforms.resize(manifest.models_size());
-            scene->model_bounds.resize(manifest.models_size());
-            for (int i = 0; i < manifest.models_size(); ++i) {
-                const auto& mi = manifest.models(i);
-                scene->models.emplace_back();
-                auto& mp = scene->models.back();
-                mp.name = mi.name();
-                mp.rel_path = mi.rel_path();
-                mp.size_bytes = mi.size_bytes();
-                mp.bytes_received.store(0);
-                mp.parsed = false;
-                scene->model_transforms[i] = glm::mat4(1.0f);
-                scene->model_bounds[i] = { glm::vec3(0.0f), 0.0f };
-            }
-            scene->current_model_index.store(0);
+    co_await ResumeOn(worker_exec_);
+    if (cancel->IsCancelled()) {
+        scene->state.store(SceneState::UNLOADED);
+        co_return;
+    }
+    // State changes are exchanges, not stores: SceneScheduler::UnloadScene may cancel and store
+    // UNLOADED at any point, and that must not be overwritten by a load that already checked.
+    SceneState queued = SceneState::QUEUED;
+    if (!scene->state.compare_exchange_strong(queued, SceneState::LOADING)) co_return;
+    auto leave_loading = [&](SceneState to) {
+        SceneState loading = SceneState::LOADING;
+        return scene->state.compare_exchange_strong(loading, to);
+    };
+
+    ManifestResult mr;
+    {
+        std::scoped_lock lk(manifests_mtx_);
+        auto it = manifests_.find(scene->scene_id);
+        if (it != manifests_.end()) {
+            mr.ok = true;
+            mr.manifest = it->second;
+        }
+    }
+    if (!mr.ok) {
+        mr = co_await client_->FetchManifest(scene->scene_id, cancel);
+        if (!mr.ok || cancel->IsCancelled()) {
+            leave_loading(cancel->IsCancelled() ? SceneState::UNLOADED : SceneState::ERROR_STATE);
+            co_return;
         }
+        // leave the completion-queue thread before touching the descriptor
+        co_await ResumeOn(worker_exec_);
+        std::scoped_lock lk(manifests_mtx_);
+        manifests_[scene->scene_id] = mr.manifest;
+    }
+    const scene::SceneManifest& manifest = mr.manifest;
 
-        // download -> parse -> prepare GL upload (main thread)
-        for (size_t i = 0; i < scene->models.size(); ++i) {
-            ModelProgress& mp = scene->models[i];
-            fs::path out_path = fs::path(tmp_dir_) / scene->scene_id / mp.rel_path;
-            fs::create_directories(out_path.parent_path());
-
-            auto progress_cb = [&](int64_t got, int64_t total) {
-                mp.bytes_received.store(got);
-            };
-
-            // Pass the explicit cancel token (cancel_requested_) so StreamModelToFile can abort mid-download.
-            bool ok = client_->StreamModelToFile(scene->scene_id, mp.rel_path, out_path.string(), mp.size_bytes, progress_cb, &cancel_requested_);
-            if (!ok) {
-                if (cancel_requested_.load()) {
-                    // Download was cancelled because loader is shutting down -> mark as UNLOADED (graceful)
-                    std::cerr << "[SceneLoader] Download cancelled for " << mp.rel_path << " (shutdown)\n";
-                    scene->state.store(SceneState::UNLOADED);
-                } else {
-                    // Actual error during streaming
-                    std::cerr << "[SceneLoader] StreamModelToFile failed for " << mp.rel_path << "\n";
-                    scene->state.store(SceneState::ERROR_STATE);
-                }
-                break;
+    // initialize per-model containers
+    std::vector<uint32_t> placed; // models the manifest gave bounds for
+    {
+        std::scoped_lock lk(scene->mtx);
+        scene->models.clear();
+        scene->mesh_handles.clear();
+        scene->model_transforms.clear();
+        scene->model_bounds.clear();
+        scene->models.reserve(manifest.models_size());
+        scene->mesh_handles.resize(manifest.models_size());
+        scene->model_transforms.resize(manifest.models_size());
+        scene->model_bounds.resize(manifest.models_size());
+        for (int i = 0; i < manifest.models_size(); ++i) {
+            const auto& mi = manifest.models(i);
+            scene->models.emplace_back();
+            auto& mp = scene->models.back();
+            mp.name = mi.name();
+            mp.rel_path = mi.rel_path();
+            // Cooked models skip the parse entirely, so fetch those rather than the source.
+            mp.cooked = Sha256::IsHexDigest(mi.cooked_hash());
+            mp.size_bytes = mp.cooked ? mi.cooked_size() : mi.size_bytes();
+            mp.bytes_received.store(0);
+            mp.parsed = false;
+            mp.triangle_count = mi.triangle_count();
+            mp.content_hash = mp.cooked ? mi.cooked_hash() : mi.content_hash();
+            mp.cancel = CancelToken::Create(cancel);
+            scene->model_transforms[i] = glm::mat4(1.0f);
+            scene->model_bounds[i] = { glm::vec3(0.0f), 0.0f };
+            if (mi.has_bounds()) {
+                NormalizeModel(StatsFromManifest(mi.bounds(), mi.triangle_count()), scene->model_transforms[i], scene->model_bounds[i]);
+                placed.push_back(static_cast<uint32_t>(i));
             }
+        }
+        scene->current_model_index.store(0);
+    }
+    if (world_) {
+        world_->PostSceneCleared(scene->scene_id);
+        // Lay the scene out before any geometry arrives (culling / picking / proximity queries).
+        std::scoped_lock lk(scene->mtx);
+        for (uint32_t i : placed) world_->PostModelPlaced(scene->scene_id, i, scene->model_transforms[i], scene->model_bounds[i]);
+    }
 
-            MeshData mesh;
-            if (!model_loader.LoadOBJToMeshData(out_path.string(), mesh, 1.0f, 50)) {
-                std::cerr << "ModelLoader failed: " << out_path << "\n";
-                scene->state.store(SceneState::ERROR_STATE);
-                break;
-            }
+    std::vector<std::shared_ptr<CancelToken>> model_tokens;
+    {
+        std::scoped_lock lk(scene->mtx);
+        for (auto& mp : scene->models) model_tokens.push_back(mp.cancel);
+    }
 
-            // compute bounding box, scale and centered model matrix (scale then translate)
-            glm::vec3 minv(FLT_MAX), maxv(-FLT_MAX);
-            for (size_t vi = 0; vi + 2 < mesh.positions.size(); vi += 3) {
-                glm::vec3 p(mesh.positions[vi + 0], mesh.positions[vi + 1], mesh.positions[vi + 2]);
-                minv = glm::min(minv, p);
-                maxv = glm::max(maxv, p);
-            }
-            glm::vec3 center = (minv + maxv) * 0.5f;
-            glm::vec3 extent = maxv - minv;
-            float max_extent = std::max(std::max(extent.x, extent.y), extent.z);
-            float orig_radius = 0.5f * max_extent;
-            float scale = (max_extent > 0.0f) ? (1.0f / max_extent) : 1.0f;
-
-            glm::mat4 T = glm::mat4(1.0f);
-            T[3] = glm::vec4(-center, 1.0f);
-            glm::mat4 S = glm::mat4(1.0f);
-            S[0][0] = scale; S[1][1] = scale; S[2][2] = scale;
-
-            // scale first, then translate: p' = scale * (p - center)
-            glm::mat4 model_matrix = S * T;
-
-            std::cerr << "[SceneLoader] Parsed " << mp.rel_path << " verts=" << (mesh.positions.size()/3)
-                      << " indices=" << mesh.indices.size() << " bbox_min=(" << minv.x << "," << minv.y << "," << minv.z
-                      << ") bbox_max=(" << maxv.x << "," << maxv.y << "," << maxv.z << ") orig_radius=" << orig_radius << " scale=" << scale << "\n";
-
-            glm::vec4 tc = model_matrix * glm::vec4(center, 1.0f);
-            float transformed_radius = orig_radius * scale;
-
-            {
-                std::scoped_lock lk(scene->mtx);
-                if (i < scene->model_bounds.size())
-                    scene->model_bounds[i] = { glm::vec3(tc), transformed_radius };
-                else {
-                    if (i >= scene->model_bounds.size()) scene->model_bounds.resize(i + 1);
-                    scene->model_bounds[i] = { glm::vec3(tc), transformed_radius };
-                }
-            }
+    // Download slots are granted in request order, so start tasks in visibility order: the model
+    // on screen first, then the ones Prev/Next would show, outwards.
+    std::vector<size_t> order(model_tokens.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    size_t active = static_cast<size_t>(std::max(0, scene->current_model_index.load()));
+    auto ring_distance = [&](size_t i) {
+        size_t d = i > active ? i - active : active - i;
+        return std::min(d, order.size() - d);
+    };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ring_distance(a) < ring_distance(b); });
 
-            // queue GL upload on main thread
-            {
-                std::vector<float> vertices = std::move(mesh.positions);
-                std::vector<uint32_t> indices = std::move(mesh.indices);
-                auto scene_wp = std::weak_ptr<SceneDescriptor>(scene);
-                std::scoped_lock lk(upload_mtx_);
-                upload_queue_.push([vertices = std::move(vertices), indices = std::move(indices), scene_wp, model_index = i, model_matrix, this]() mutable {
-                    auto scene_sp = scene_wp.lock();
-                    if (!scene_sp) return;
-                    MeshHandle h = renderer_->UploadMesh(vertices, indices);
-                    {
-                        std::scoped_lock lk(scene_sp->mtx);
-                        if (model_index < scene_sp->mesh_handles.size()) {
-                            scene_sp->mesh_handles[model_index] = h;
-                            scene_sp->model_transforms[model_index] = model_matrix;
-                        }
-                    }
-                    std::cerr << "[SceneLoader][UploadTask] Stored MeshHandle VAO=" << h.vao << " for model_index=" << model_index << "\n";
-                });
-            }
-            upload_cv_.notify_one();
+    std::shared_ptr<ScenePack> pack;
+    if (!manifest.pack_id().empty()) pack = co_await FetchPack(scene, manifest.pack_id(), cancel);
+    if (cancel->IsCancelled()) {
+        leave_loading(SceneState::UNLOADED);
+        co_return;
+    }
+
+    std::vector<Task<bool>> model_tasks;
+    model_tasks.reserve(model_tokens.size());
+    for (size_t i : order) {
+        model_tasks.push_back(LoadModel(scene, i, model_tokens[i], pack));
+    }
+    size_t succeeded = co_await WhenAll(std::move(model_tasks));
+
+    // Models cancelled individually don't fail the scene.
+    size_t skipped = 0;
+    for (auto& t : model_tokens) if (t->IsCancelled()) ++skipped;
+
+    if (cancel->IsCancelled()) {
+        // Unloaded or shutting down -> UNLOADED (graceful)
+        leave_loading(SceneState::UNLOADED);
+    } else if (succeeded + skipped >= model_tokens.size()) {
+        // Fails if an unload got in after the check above; the scene stays UNLOADED then.
+        if (leave_loading(SceneState::LOADED) && world_) world_->PostSceneLoaded(scene->scene_id, true);
+    } else {
+        leave_loading(SceneState::ERROR_STATE);
+    }
+}
+
+Task<std::shared_ptr<ScenePack>> SceneLoader::FetchPack(std::shared_ptr<SceneDescriptor> scene, std::string pack_id,
+                                                        std::shared_ptr<CancelToken> cancel) {
+    // Only ids we produced ourselves name files under tmp_dir_.
+    if (pack_id.size() != 16 || pack_id.find_first_not_of("0123456789abcdef") != std::string::npos) co_return nullptr;
+    fs::path pack_dir = fs::path(tmp_dir_) / "packs" / scene->scene_id;
+    fs::path pack_path = pack_dir / (pack_id + ".p4pack");
+    fs::path part_path = pack_dir / (pack_id + ".p4pack.part");
+
+    // Packs are verified before they are renamed into place, so a cached one is opened as is.
+    std::string error;
+    auto pack = std::make_shared<ScenePack>();
+    if (pack->Open(pack_path, error)) {
+        for (auto& mp : scene->models) mp.bytes_received.store(mp.size_bytes);
+        co_return pack;
+    }
+
+    // With most models already in the blob cache the pack would mostly re-download them.
+    int64_t total = 0;
+    int64_t missing = 0;
+    for (auto& mp : scene->models) {
+        total += mp.size_bytes;
+        std::error_code ec;
+        fs::path blob = fs::path(tmp_dir_) / "blobs" / mp.content_hash;
+        if (!Sha256::IsHexDigest(mp.content_hash) || fs::file_size(blob, ec) != static_cast<uintmax_t>(mp.size_bytes) || ec) {
+            missing += mp.size_bytes;
+        }
+    }
+    if (total <= 0 || missing * 2 < total) co_return nullptr;
+
+    if (!co_await download_slots_.Acquire()) co_return nullptr;
+    if (cancel->IsCancelled()) {
+        download_slots_.Release();
+        co_return nullptr;
+    }
+    // A previous attempt (or run) left a prefix; ask for the rest only.
+    std::error_code ec;
+    int64_t offset = static_cast<int64_t>(fs::file_size(part_path, ec));
+    if (ec) offset = 0;
+    // Progress is spread over the models in proportion to their size.
+    auto progress_cb = [scene, offset](int64_t got, int64_t pack_size) {
+        if (pack_size <= 0) return;
+        double fraction = std::min(1.0, static_cast<double>(offset + got) / static_cast<double>(pack_size));
+        for (auto& mp : scene->models) mp.bytes_received.store(static_cast<int64_t>(static_cast<double>(mp.size_bytes) * fraction));
+    };
+    auto dl_start = std::chrono::steady_clock::now();
+    DownloadResult dl = co_await client_->DownloadPack(scene->scene_id, pack_id, offset, total - offset, progress_cb, cancel);
+    download_slots_.Release();
+    if (!cancel->IsCancelled()) {
+        download_slots_.SetLimit(download_limiter_.OnSample(std::chrono::steady_clock::now() - dl_start,
+                                                            static_cast<double>(dl.data.size()), dl.ok));
+    }
+
+    co_await ResumeOn(worker_exec_);
+    // Keep whatever arrived, even from a failed or cancelled stream, for the next attempt.
+    if (!dl.data.empty() && !AppendPart(part_path, dl.data)) {
+        std::cerr << "[SceneLoader] Failed to write " << part_path << "\n";
+        fs::remove(part_path, ec);
+        co_return nullptr;
+    }
+    if (!dl.ok) {
+        if (!cancel->IsCancelled()) std::cerr << "[SceneLoader] Pack download failed for " << scene->scene_id << " (loading models one by one)\n";
+        co_return nullptr;
+    }
+    std::string().swap(dl.data);
 
+    if (!pack->Open(part_path, error) || !pack->Verify(error)) {
+        std::cerr << "[SceneLoader] Discarding pack for " << scene->scene_id << ": " << error << "\n";
+        *pack = ScenePack();
+        fs::remove(part_path, ec);
+        co_return nullptr;
+    }
+    *pack = ScenePack();
+    fs::rename(part_path, pack_path, ec);
+    fs::path final_path = ec ? part_path : pack_path;
+    // Older packs (and parts) of the scene won't be asked for again.
+    for (const auto& de : fs::directory_iterator(pack_dir, ec)) {
+        if (de.path() != final_path) fs::remove(de.path(), ec);
+    }
+    if (!pack->Open(final_path, error)) {
+        std::cerr << "[SceneLoader] Failed to map pack for " << scene->scene_id << ": " << error << "\n";
+        co_return nullptr;
+    }
+    std::cerr << "[SceneLoader] Pack for " << scene->scene_id << " ready (" << pack->Entries().size() << " models)\n";
+    co_return pack;
+}
+
+Task<bool> SceneLoader::LoadModel(std::shared_ptr<SceneDescriptor> scene, size_t i, std::shared_ptr<CancelToken> cancel,
+                                  std::shared_ptr<ScenePack> pack) {
+    // Safe to hold: scene->models is only rebuilt once this load has fully unwound (load_active).
+    ModelProgress& mp = scene->models[i];
+
+    // Content-addressed models are cached once under tmp_dir_/blobs, whichever scene fetched them,
+    // so props shared between scenes are downloaded once (and not at all on later runs).
+    fs::path blob_path;
+    if (Sha256::IsHexDigest(mp.content_hash)) blob_path = fs::path(tmp_dir_) / "blobs" / mp.content_hash;
+
+    // Same content already on the GPU for another scene (or an earlier load of this one): take a
+    // reference to it instead of fetching and parsing the model again.
+    if (!blob_path.empty() && meshes_->Contains(mp.content_hash)) {
+        co_await ResumeOn(main_exec_);
+        if (cancel->IsCancelled()) co_return false;
+        MeshStats stats;
+        MeshHandle h = meshes_->Acquire(mp.content_hash, &stats);
+        // Released between the check and this hop: fall through to the normal path.
+        if (h.vao) {
             mp.bytes_received.store(mp.size_bytes);
             mp.parsed = true;
+            co_return PublishModel(scene, i, h, stats);
         }
+    }
 
-        if (scene->state.load() != SceneState::ERROR_STATE) {
-            scene->state.store(SceneState::LOADED);
+    // The bytes to parse: a view into the pack mapping, or dl.data.
+    std::string_view bytes;
+    DownloadResult dl;
+    const PackEntry* entry = pack ? pack->Find(mp.rel_path) : nullptr;
+    if (entry && (mp.content_hash.empty() || entry->content_hash == mp.content_hash)) {
+        co_await ResumeOn(worker_exec_);
+        if (cancel->IsCancelled()) co_return false;
+        std::string error;
+        dl.ok = pack->Read(*entry, dl.data, bytes, error);
+        if (!dl.ok) std::cerr << "[SceneLoader] Can't read " << mp.rel_path << " from pack: " << error << "\n";
+    }
+
+    if (!dl.ok && !blob_path.empty()) {
+        // Spread cache reads over the workers rather than reading every model on this one.
+        co_await ResumeOn(worker_exec_);
+        if (cancel->IsCancelled()) co_return false;
+        dl.ok = ReadCachedBlob(blob_path, mp.size_bytes, mp.content_hash, dl.data);
+        if (dl.ok) mp.bytes_received.store(mp.size_bytes);
+    }
+
+    if (!dl.ok) {
+        if (!co_await download_slots_.Acquire()) co_return false;
+        if (cancel->IsCancelled()) {
+            download_slots_.Release();
+            co_return false;
+        }
+        auto progress_cb = [&mp](int64_t got, int64_t /*total*/) {
+            mp.bytes_received.store(got);
+        };
+        // The token aborts the stream immediately when the model, its scene or the loader is cancelled.
+        auto dl_start = std::chrono::steady_clock::now();
+        dl = co_await client_->DownloadModel(scene->scene_id, mp.rel_path, mp.size_bytes, progress_cb, cancel,
+                                             blob_path.empty() ? std::string() : mp.content_hash);
+        download_slots_.Release();
+        if (!cancel->IsCancelled()) {
+            size_t limit = download_limiter_.OnSample(std::chrono::steady_clock::now() - dl_start,
+                                                      static_cast<double>(dl.data.size()), dl.ok);
+            download_slots_.SetLimit(limit);
+        }
+        if (!dl.ok) {
+            if (cancel->IsCancelled()) std::cerr << "[SceneLoader] Download cancelled for " << mp.rel_path << "\n";
+            else std::cerr << "[SceneLoader] Download failed for " << mp.rel_path << "\n";
+            co_return false;
+        }
+
+        // Verify on a worker, which is also where the write and parsing continue.
+        co_await ResumeOn(worker_exec_);
+        if (!blob_path.empty() && Sha256::HexDigest(dl.data) != mp.content_hash) {
+            std::cerr << "[SceneLoader] Content hash mismatch for " << mp.rel_path << "\n";
+            co_return false;
+        }
+        // Keep a copy under tmp_dir_ (in the blob cache when the model has a hash).
+        fs::path out_path = blob_path.empty() ? fs::path(tmp_dir_) / scene->scene_id / mp.rel_path : blob_path;
+        if (!co_await WriteFileOn{ worker_exec_, out_path.string(), dl.data }) {
+            std::cerr << "[SceneLoader] Failed to write " << out_path << " (continuing from memory)\n";
         }
     }
+    if (bytes.empty()) bytes = dl.data;
+    // Parse work queued behind a cancel is dropped here.
+    if (cancel->IsCancelled()) co_return false;
+
+    // Waiters are re-posted to a worker so a finishing parse never runs the next one inline.
+    if (!co_await parse_slots_.Acquire(&worker_exec_)) co_return false;
+    if (cancel->IsCancelled()) {
+        parse_slots_.Release();
+        co_return false;
+    }
+    ModelLoader model_loader;
+    MeshData mesh(&MeshBufferPool::Instance());
+    auto parse_start = std::chrono::steady_clock::now();
+    bool parsed = false;
+    if (mp.cooked) {
+        std::string error;
+        parsed = DecodeCookedMesh(bytes, 0, mesh, error);
+        if (!parsed) std::cerr << "[SceneLoader] Bad cooked mesh for " << mp.rel_path << ": " << error << "\n";
+    } else {
+        parsed = model_loader.LoadMeshFromMemory(bytes, mp.rel_path, mesh, 1.0f, 50);
+    }
+    // A malformed file says nothing about CPU contention, so only successful parses are sampled.
+    if (parsed) {
+        parse_slots_.SetLimit(parse_limiter_.OnSample(std::chrono::steady_clock::now() - parse_start,
+                                                      static_cast<double>(bytes.size()), true));
+    }
+    parse_slots_.Release();
+    bytes = {};
+    std::string().swap(dl.data); // release the download buffer early
+    if (!parsed) {
+        std::cerr << "ModelLoader failed: " << mp.rel_path << "\n";
+        co_return false;
+    }
+
+    // Normalize from the parsed mesh; matches the manifest placement when the server sent bounds.
+    MeshStats stats = ComputeMeshStats(mesh);
+    glm::mat4 model_matrix;
+    ModelBounds bounds;
+    NormalizeModel(stats, model_matrix, bounds);
+
+    std::cerr << "[SceneLoader] Parsed " << mp.rel_path << " verts=" << (mesh.positions.size()/3)
+              << " indices=" << mesh.indices.size() << " bbox_min=(" << stats.aabb_min[0] << "," << stats.aabb_min[1] << "," << stats.aabb_min[2]
+              << ") bbox_max=(" << stats.aabb_max[0] << "," << stats.aabb_max[1] << "," << stats.aabb_max[2] << ") radius=" << stats.sphere_radius << "\n";
+
+    {
+        std::scoped_lock lk(scene->mtx);
+        if (i >= scene->model_bounds.size()) scene->model_bounds.resize(i + 1);
+        scene->model_bounds[i] = bounds;
+    }
+
+    mp.bytes_received.store(mp.size_bytes);
+    mp.parsed = true;
+
+    // Only the verified hash may key a shared mesh; pack entries of unhashed models upload unshared.
+    const std::string mesh_key = blob_path.empty() ? std::string() : mp.content_hash;
+    if (cancel->IsCancelled()) co_return false;
+
+    // With an upload thread the buffers are filled there, and only the VAO is made on the main
+    // thread. Skipped if another scene already made this mesh resident.
+    if (uploader_ && uploader_->Running() && !meshes_->Contains(mesh_key)) {
+        GLUploadThread::Result up = co_await uploader_->Upload(std::move(mesh), &main_exec_);
+        if (!up.ok) co_return false; // the upload thread stopped (shutdown)
+        if (cancel->IsCancelled()) {
+            meshes_->Discard(up.buffers);
+            co_return false;
+        }
+        co_return PublishModel(scene, i, meshes_->Adopt(mesh_key, up.buffers, stats), stats);
+    }
+
+    // GL upload must happen on the main thread.
+    co_await ResumeOn(main_exec_);
+    // Re-check on the main thread: an unload there may have run while this upload was queued.
+    if (cancel->IsCancelled()) co_return false;
+    MeshHandle h = meshes_->Upload(mesh_key, mesh, stats);
+    co_return PublishModel(scene, i, h, stats);
+}
+
+bool SceneLoader::PublishModel(const std::shared_ptr<SceneDescriptor>& scene, size_t i, MeshHandle h, const MeshStats& stats) {
+    glm::mat4 model_matrix;
+    ModelBounds bounds;
+    NormalizeModel(stats, model_matrix, bounds);
+    bool stored = false;
+    {
+        // Posted under the scene lock, so an unload (which clears the handles and the world's
+        // models under the same lock) can't slip between storing the handle and announcing it.
+        std::scoped_lock lk(scene->mtx);
+        if (i < scene->mesh_handles.size()) {
+            scene->mesh_handles[i] = h;
+            scene->model_transforms[i] = model_matrix;
+            if (i >= scene->model_bounds.size()) scene->model_bounds.resize(i + 1);
+            scene->model_bounds[i] = bounds;
+            if (world_) world_->PostModelReady(scene->scene_id, static_cast<uint32_t>(i), h, model_matrix, bounds);
+            stored = true;
+        }
+    }
+    // Nobody would release a reference the scene doesn't hold.
+    if (!stored) {
+        meshes_->Release(h);
+        return false;
+    }
+    std::cerr << "[SceneLoader][UploadTask] Stored MeshHandle VAO=" << h.vao << " for model_index=" << i << "\n";
+    return true;
 }
\ No newline at end of file
@@ -2,48 +2,138 @@
 
 #include "scene_types.h"
 #include "scene_client.h" // your existing SceneClient
+#include "load_task.h"
+#include "concurrency_limiter.h"
+#include "unique_task.h"
 #include <functional>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
+#include <unordered_map>
+#include <vector>
 
-// GL upload task queue type (executed on main thread)
-using GLUploadTask = std::function<void()>;
+// GL upload task queue type (executed on the GL thread). Move-only and non-allocating.
+using GLUploadTask = UniqueTask;
 
 // Forward-declare renderer
-class GLRenderer;
+class MeshRegistry;
+class GLUploadThread;
+struct MeshStats;
+class RenderWorld;
+class ScenePack;
 
 class SceneLoader {
 public:
-    // worker_count: number of background loader threads (default 4)
-    SceneLoader(SceneClient* client, GLRenderer* renderer, std::queue<GLUploadTask>& upload_queue, std::mutex& upload_mtx, std::condition_variable& upload_cv, const std::string& tmp_dir = "tmp", size_t worker_count = 4);
+    // worker_count: background CPU threads resuming load coroutines (0 = hardware_concurrency).
+    // max_inflight_downloads: upper bound for async model streams open at once across all scenes.
+    // Downloads don't occupy a worker; the SceneClient completion-queue threads drive them.
+    // The actual download and parse concurrency adapts between 1 and these bounds from measured
+    // per-byte latency (see ConcurrencyLimiter).
+    // GPU meshes go through `meshes`, so a model already resident for another scene is shared
+    // instead of downloaded, parsed and uploaded again.
+    SceneLoader(SceneClient* client, MeshRegistry* meshes, std::queue<GLUploadTask>& upload_queue, std::mutex& upload_mtx, std::condition_variable& upload_cv, const std::string& tmp_dir = "tmp", size_t worker_count = 0, size_t max_inflight_downloads = 64);
     ~SceneLoader();
 
-    // Enqueue a scene to load asynchronously (returns immediately)
-    void EnqueueLoad(const std::shared_ptr<SceneDescriptor>& scene);
+    // Enqueue a scene to load asynchronously (returns immediately).
+    // Returns false if a previous (cancelled) load of the scene is still unwinding; retry later.
+    bool EnqueueLoad(const std::shared_ptr<SceneDescriptor>& scene);
+
+    // Cancel the scene's in-flight load: open streams are aborted, queued parse work is dropped
+    // and pending GL uploads are skipped. Other scenes keep loading.
+    void CancelLoad(const std::shared_ptr<SceneDescriptor>& scene);
+
+    // Cancel a single model of the current load; the rest of the scene still loads.
+    void CancelModel(const std::shared_ptr<SceneDescriptor>& scene, size_t model_index);
+
+    // Fetch the manifests of many scenes in one GetSceneManifests round trip and keep them, so
+    // their loads skip the per-scene manifest RPC. Blocks until the stream ends; run it off the
+    // main thread. Aborted by Shutdown.
+    void PrefetchManifests(const std::vector<std::string>& scene_ids);
+    // Drop a cached manifest (the scene changed on the server or left the catalog).
+    void InvalidateManifest(const std::string& scene_id);
+
+    // Optional render-side world that receives model/scene events. Set before the first load.
+    void SetRenderWorld(RenderWorld* world) { world_ = world; }
+    // Optional upload thread for mesh buffers; while it runs, the main thread only creates VAOs.
+    // Set before the first load.
+    void SetUploadThread(GLUploadThread* uploader) { uploader_ = uploader; }
 
     // Cancel all work and join threads
     void Shutdown();
 
 private:
+    // Resumes coroutines on the loader's worker threads.
+    class WorkerExecutor final : public ResumeExecutor {
+    public:
+        explicit WorkerExecutor(SceneLoader* owner) : owner_(owner) {}
+        void Post(std::coroutine_handle<> h) override;
+    private:
+        SceneLoader* owner_;
+    };
+
+    // Resumes coroutines on the GL thread by posting to the GL upload queue (run by the render
+    // thread while it owns the context, by the main thread otherwise).
+    class MainThreadExecutor final : public ResumeExecutor {
+    public:
+        explicit MainThreadExecutor(SceneLoader* owner) : owner_(owner) {}
+        void Post(std::coroutine_handle<> h) override;
+    private:
+        SceneLoader* owner_;
+    };
+
     void WorkerThread();
+    static size_t ResolveWorkerCount(size_t requested);
+
+    // Whole scene load: manifest -> every model concurrently -> final scene state.
+    DetachedTask LoadScene(std::shared_ptr<SceneDescriptor> scene, std::shared_ptr<CancelToken> cancel);
+    // The scene's pack from tmp_dir_/packs, or downloaded (resuming a partial download) and
+    // verified first. Null when the scene is better loaded model by model (most models already
+    // in the blob cache) or the pack couldn't be fetched.
+    Task<std::shared_ptr<ScenePack>> FetchPack(std::shared_ptr<SceneDescriptor> scene, std::string pack_id, std::shared_ptr<CancelToken> cancel);
+    // One model: pack entry, cached blob or download -> mirror to tmp -> parse (worker) -> GL
+    // upload (main thread). Pack entries are parsed straight from the mapping; cooked models
+    // are copied out of their .p4mesh instead of parsed.
+    // `cancel` is checked at every hop so a cancelled model never reaches the GL upload.
+    Task<bool> LoadModel(std::shared_ptr<SceneDescriptor> scene, size_t model_index, std::shared_ptr<CancelToken> cancel,
+                         std::shared_ptr<ScenePack> pack);
+    // GL thread: stores model i's mesh, transform and bounds and announces it to the render
+    // world. Returns false (releasing h) if the scene's handle table no longer has the slot.
+    bool PublishModel(const std::shared_ptr<SceneDescriptor>& scene, size_t i, MeshHandle h, const MeshStats& stats);
 
     SceneClient* client_;
-    GLRenderer* renderer_;
+    MeshRegistry* meshes_;
+    RenderWorld* world_ = nullptr;
+    GLUploadThread* uploader_ = nullptr;
     std::string tmp_dir_;
     std::vector<std::thread> workers_;
     std::atomic<bool> running_{ true };
-    std::atomic<bool> cancel_requested_{ false }; 
+    std::atomic<size_t> active_loads_{ 0 }; // LoadScene frames alive; see MeshBufferPool
+    // Root of every scene/model token; cancelled on Shutdown.
+    std::shared_ptr<CancelToken> shutdown_token_ = CancelToken::Create();
     size_t worker_count_{ 1 };
 
+    // Coroutines waiting to be resumed by a worker.
     std::mutex queue_mtx_;
     std::condition_variable queue_cv_;
-    std::deque<std::shared_ptr<SceneDescriptor>> queue_;
+    std::deque<std::coroutine_handle<>> ready_;
+
+    // Manifests from PrefetchManifests or earlier loads, by scene id.
+    std::mutex manifests_mtx_;
+    std::unordered_map<std::string, scene::SceneManifest> manifests_;
+
+    // Limits concurrently open model streams and concurrent parses; limits are driven by the limiters.
+    ConcurrencyLimiter download_limiter_;
+    ConcurrencyLimiter parse_limiter_;
+    AsyncSemaphore download_slots_;
+    AsyncSemaphore parse_slots_;
+    WorkerExecutor worker_exec_{ this };
+    MainThreadExecutor main_exec_{ this };
 
-    // GL upload queue references (main thread will pop)
+    // GL upload queue references (the GL thread will pop)
     std::queue<GLUploadTask>& upload_queue_;
     std::mutex& upload_mtx_;
     std::condition_variable& upload_cv_;
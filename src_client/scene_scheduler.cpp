@@ -5,7 +5,8 @@
 using namespace std::chrono_literals;
 
 // SceneScheduler schedules background loads and keeps scene descriptors.
-SceneScheduler::SceneScheduler(SceneLoader* loader) : loader_(loader) {}
+SceneScheduler::SceneScheduler(SceneLoader* loader, NavigationModel* nav, int residency_budget)
+    : loader_(loader), nav_(nav), residency_budget_(std::max(1, residency_budget)) {}
 SceneScheduler::~SceneScheduler() { Stop(); }
 
 void SceneScheduler::RegisterScene(const std::string& scene_id) {
@@ -24,28 +25,53 @@ void SceneScheduler::Start() {
 }
 
 void SceneScheduler::Stop() {
-    running_.store(false);
+    {
+        std::scoped_lock lk(mtx_);
+        running_.store(false);
+    }
+    wake_cv_.notify_all();
     if (sched_thread_.joinable()) sched_thread_.join();
+    if (nav_) nav_->Save();
 }
 
-// Move prioritized scene to map end so it is considered first.
 void SceneScheduler::PrioritizeScene(const std::string& scene_id) {
-    std::scoped_lock lk(mtx_);
-    auto it = scenes_.find(scene_id);
-    if (it != scenes_.end()) {
-        auto sd = it->second;
-        scenes_.erase(it);
-        scenes_.emplace(scene_id, sd);
+    {
+        std::scoped_lock lk(mtx_);
+        if (scenes_.find(scene_id) == scenes_.end()) return;
+        priority_scene_ = scene_id;
     }
+    if (nav_) nav_->RecordView(scene_id);
+    // React now rather than on the next poll so the selected scene starts immediately.
+    wake_cv_.notify_all();
 }
 
 void SceneScheduler::UnloadScene(const std::string& scene_id) {
-    std::scoped_lock lk(mtx_);
-    auto it = scenes_.find(scene_id);
-    if (it != scenes_.end()) {
-        it->second->state.store(SceneState::UNLOADED);
-        // GL cleanup handled by main thread.
+    std::shared_ptr<SceneDescriptor> sd;
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = scenes_.find(scene_id);
+        if (it == scenes_.end()) return;
+        sd = it->second;
     }
+    // Abort only this scene's in-flight load; other scenes keep streaming.
+    loader_->CancelLoad(sd);
+    sd->state.store(SceneState::UNLOADED);
+    // GL cleanup handled by main thread.
+}
+
+void SceneScheduler::RemoveScene(const std::string& scene_id) {
+    std::shared_ptr<SceneDescriptor> sd;
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = scenes_.find(scene_id);
+        if (it == scenes_.end()) return;
+        sd = std::move(it->second);
+        scenes_.erase(it);
+        if (priority_scene_ == scene_id) priority_scene_.clear();
+    }
+    loader_->CancelLoad(sd);
+    sd->state.store(SceneState::UNLOADED);
+    wake_cv_.notify_all();
 }
 
 std::vector<std::shared_ptr<SceneDescriptor>> SceneScheduler::GetAllScenes() {
@@ -56,33 +82,57 @@ std::vector<std::shared_ptr<SceneDescriptor>> SceneScheduler::GetAllScenes() {
     return out;
 }
 
-// Scheduler thread: keep up to N scenes loading concurrently (N=5 here).
+std::vector<std::shared_ptr<SceneDescriptor>> SceneScheduler::BuildLoadOrder(const std::string& priority) {
+    // Predict from the scene on screen; before the first View this is the session start state.
+    std::vector<std::string> predicted;
+    if (nav_) predicted = nav_->PredictNext(priority);
+
+    std::scoped_lock lk(mtx_);
+    std::vector<std::shared_ptr<SceneDescriptor>> order;
+    order.reserve(scenes_.size());
+    auto push = [&](const std::string& id) {
+        auto it = scenes_.find(id);
+        if (it == scenes_.end()) return;
+        if (std::find(order.begin(), order.end(), it->second) == order.end()) order.push_back(it->second);
+    };
+    if (!priority.empty()) push(priority);
+    for (auto& id : predicted) push(id);
+    for (auto& p : scenes_) push(p.first);
+    return order;
+}
+
+// Scheduler thread: keep up to residency_budget_ scenes loaded or loading. The viewed scene
+// always starts first; prefetches of predicted scenes only start while it isn't downloading,
+// so they never compete with the scene the user is waiting for.
 void SceneScheduler::SchedulerThread() {
     while (running_.load()) {
-        std::vector<std::shared_ptr<SceneDescriptor>> snapshot;
+        std::string priority;
         {
             std::scoped_lock lk(mtx_);
-            for (auto& p : scenes_) snapshot.push_back(p.second);
+            priority = priority_scene_;
         }
+        std::vector<std::shared_ptr<SceneDescriptor>> order = BuildLoadOrder(priority);
 
         int loaded_or_loading = 0;
-        for (auto& s : snapshot) {
+        bool foreground_busy = false;
+        for (auto& s : order) {
             SceneState st = s->state.load();
             if (st == SceneState::LOADED || st == SceneState::LOADING) ++loaded_or_loading;
+            if (s->scene_id == priority && (st == SceneState::QUEUED || st == SceneState::LOADING)) foreground_busy = true;
         }
 
-        int to_start = std::max(0, 5 - loaded_or_loading);
-        if (to_start > 0) {
-            for (auto& s : snapshot) {
-                if (to_start <= 0) break;
-                if (s->state.load() == SceneState::UNLOADED) {
-                    s->state.store(SceneState::QUEUED);
-                    loader_->EnqueueLoad(s);
-                    --to_start;
-                }
-            }
+        int to_start = std::max(0, residency_budget_ - loaded_or_loading);
+        for (auto& s : order) {
+            bool is_priority = !priority.empty() && s->scene_id == priority;
+            if (!is_priority && (to_start <= 0 || foreground_busy)) break;
+            if (s->state.load() != SceneState::UNLOADED) continue;
+            // A cancelled load may still be unwinding; EnqueueLoad refuses until it has.
+            if (!loader_->EnqueueLoad(s)) continue;
+            if (is_priority) foreground_busy = true;
+            else --to_start;
         }
 
-        std::this_thread::sleep_for(200ms);
+        std::unique_lock lk(mtx_);
+        wake_cv_.wait_for(lk, 200ms, [&]() { return !running_.load() || priority_scene_ != priority; });
     }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "scene_types.h"
 #include "scene_loader.h"
+#include "navigation_model.h"
 #include <map>
 #include <vector>
 #include <memory>
@@ -9,10 +10,13 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
 
 class SceneScheduler {
 public:
-    explicit SceneScheduler(SceneLoader* loader);
+    // nav: optional navigation model used to prefetch likely next scenes (may be null).
+    // residency_budget: max scenes kept LOADED or LOADING (the viewed scene may exceed it).
+    explicit SceneScheduler(SceneLoader* loader, NavigationModel* nav = nullptr, int residency_budget = 5);
     ~SceneScheduler();
 
     // Add/register a scene id (doesn't start loading immediately)
@@ -24,21 +28,32 @@ public:
     // Stop and join
     void Stop();
 
-    // Request the scheduler to prioritize a scene (user selects)
+    // Request the scheduler to prioritize a scene (user selects). Also records the
+    // navigation step, and prefetching then follows the scenes predicted after it.
     void PrioritizeScene(const std::string& scene_id);
 
     // Unload a scene (free resources logically)
     void UnloadScene(const std::string& scene_id);
 
+    // Forget a scene that left the catalog: its load is cancelled and it is no longer scheduled.
+    // The caller frees its GL resources first, as for UnloadScene.
+    void RemoveScene(const std::string& scene_id);
+
     // Query all descriptors (thread-safe snapshot)
     std::vector<std::shared_ptr<SceneDescriptor>> GetAllScenes();
 
 private:
     void SchedulerThread();
+    // Prioritized scene, then predicted next scenes, then the rest in registration order.
+    std::vector<std::shared_ptr<SceneDescriptor>> BuildLoadOrder(const std::string& priority);
 
     SceneLoader* loader_;
+    NavigationModel* nav_;
+    int residency_budget_;
     std::map<std::string, std::shared_ptr<SceneDescriptor>> scenes_;
+    std::string priority_scene_; // guarded by mtx_
     std::mutex mtx_;
+    std::condition_variable wake_cv_;
     std::thread sched_thread_;
     std::atomic<bool> running_{ false };
 };
\ No newline at end of file
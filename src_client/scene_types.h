@@ -7,6 +7,7 @@
 #include <memory>
 #include <glm/glm.hpp>
 #include "gl_renderer.h"
+#include "cancel_token.h"
 
 enum class SceneState { UNLOADED, QUEUED, LOADING, LOADED, ERROR_STATE };
 
@@ -16,25 +17,39 @@ struct ModelProgress {
     int64_t size_bytes = 0;
     std::atomic<int64_t> bytes_received{0};
     bool parsed = false;
+    // From the manifest (0 if the server couldn't parse the model).
+    int64_t triangle_count = 0;
+    // Hex SHA-256 of what gets downloaded (from the manifest); models with the same hash share one
+    // download and cache file.
+    std::string content_hash;
+    // Downloaded as the P4_Cook output (.p4mesh) instead of the source file; size_bytes and
+    // content_hash then describe the cooked file.
+    bool cooked = false;
+    // Per-model cancellation (child of the scene's load token).
+    std::shared_ptr<CancelToken> cancel;
 
     ModelProgress() = default;
     ModelProgress(const ModelProgress& o)
         : name(o.name), rel_path(o.rel_path), size_bytes(o.size_bytes),
-          bytes_received(o.bytes_received.load()), parsed(o.parsed) {}
+          bytes_received(o.bytes_received.load()), parsed(o.parsed), triangle_count(o.triangle_count),
+          content_hash(o.content_hash), cooked(o.cooked), cancel(o.cancel) {}
     ModelProgress& operator=(const ModelProgress& o) {
         if (this != &o) {
             name = o.name; rel_path = o.rel_path; size_bytes = o.size_bytes;
             bytes_received.store(o.bytes_received.load()); parsed = o.parsed;
+            triangle_count = o.triangle_count; content_hash = o.content_hash; cooked = o.cooked; cancel = o.cancel;
         }
         return *this;
     }
     ModelProgress(ModelProgress&& o) noexcept
         : name(std::move(o.name)), rel_path(std::move(o.rel_path)), size_bytes(o.size_bytes),
-          bytes_received(o.bytes_received.load()), parsed(o.parsed) {}
+          bytes_received(o.bytes_received.load()), parsed(o.parsed), triangle_count(o.triangle_count),
+          content_hash(std::move(o.content_hash)), cooked(o.cooked), cancel(std::move(o.cancel)) {}
     ModelProgress& operator=(ModelProgress&& o) noexcept {
         if (this != &o) {
             name = std::move(o.name); rel_path = std::move(o.rel_path); size_bytes = o.size_bytes;
             bytes_received.store(o.bytes_received.load()); parsed = o.parsed;
+            triangle_count = o.triangle_count; content_hash = std::move(o.content_hash); cooked = o.cooked; cancel = std::move(o.cancel);
         }
         return *this;
     }
@@ -59,11 +74,18 @@ struct SceneDescriptor {
     // model transforms per model (local transform)
     std::vector<glm::mat4> model_transforms;
 
-    // per-model bounds in scene-local space (center + radius)
+    // per-model bounds in scene-local space (center + radius). Filled from the manifest when the
+    // server provides bounds, so models are placed before their geometry arrives.
     std::vector<ModelBounds> model_bounds;
 
     // Index of the currently visible model (preloaded models remain available)
     std::atomic<int> current_model_index{0};
 
+    // Cancellation for the current load (replaced on every EnqueueLoad). Guarded by mtx.
+    std::shared_ptr<CancelToken> load_token;
+    // True from EnqueueLoad until the load coroutine has fully unwound (including cancelled
+    // downloads). A new load of the same scene must wait for this to drop.
+    std::atomic<bool> load_active{ false };
+
     std::mutex mtx; // protects descriptor fields that aren't atomic
 };
\ No newline at end of file
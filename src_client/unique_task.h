@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only void() callable with inline storage and no heap fallback: constructing one never
+// allocates, and a callable that doesn't fit fails to compile. Replaces std::function in the GL
+// upload queue, where tasks are created per model and only ever run once.
+class UniqueTask {
+public:
+    static constexpr size_t kCapacity = 48;
+
+    UniqueTask() noexcept = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, UniqueTask>>>
+    UniqueTask(F&& fn) {
+        using Fn = std::decay_t<F>;
+        static_assert(sizeof(Fn) <= kCapacity, "UniqueTask: callable too large for inline storage");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "UniqueTask: callable over-aligned");
+        static_assert(std::is_nothrow_move_constructible_v<Fn>, "UniqueTask: callable must be nothrow-movable");
+        ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(fn));
+        ops_ = &kOps<Fn>;
+    }
+
+    UniqueTask(UniqueTask&& o) noexcept { MoveFrom(o); }
+    UniqueTask& operator=(UniqueTask&& o) noexcept {
+        if (this != &o) {
+            Reset();
+            MoveFrom(o);
+        }
+        return *this;
+    }
+    UniqueTask(const UniqueTask&) = delete;
+    UniqueTask& operator=(const UniqueTask&) = delete;
+    ~UniqueTask() { Reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+    void operator()() { ops_->invoke(storage_); }
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src) noexcept; // move-construct into dst, destroy src
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr Ops kOps{
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); },
+    };
+
+    void MoveFrom(UniqueTask& o) noexcept {
+        if (o.ops_) {
+            o.ops_->move(storage_, o.storage_);
+            ops_ = std::exchange(o.ops_, nullptr);
+        }
+    }
+    void Reset() noexcept {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kCapacity];
+    const Ops* ops_ = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "cooked_mesh.h"
+#include "sha256.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+static constexpr char kMagic[8] = { 'P', '4', 'M', 'E', 'S', 'H', '0', '1' };
+static constexpr size_t kHeaderSize = 96;
+static constexpr size_t kLodEntrySize = 16;
+static constexpr size_t kDataAlignment = 16;
+
+static uint64_t AlignUp(uint64_t v, uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+static void PutU32(std::string& s, uint32_t v) {
+    for (int i = 0; i < 4; ++i) s.push_back(static_cast<char>(v >> (8 * i)));
+}
+static void PutU64(std::string& s, uint64_t v) {
+    for (int i = 0; i < 8; ++i) s.push_back(static_cast<char>(v >> (8 * i)));
+}
+static void PutF32(std::string& s, float v) {
+    PutU32(s, std::bit_cast<uint32_t>(v));
+}
+static uint64_t GetLE(const char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | static_cast<uint8_t>(p[i]);
+    return v;
+}
+static float GetF32(const char* p) {
+    return std::bit_cast<float>(static_cast<uint32_t>(GetLE(p, 4)));
+}
+
+// Appends a run of 32-bit values in little-endian order (a single copy on little-endian hosts).
+template <typename T>
+static void PutArray(std::string& s, const T* v, size_t count) {
+    static_assert(sizeof(T) == 4);
+    if constexpr (std::endian::native == std::endian::little) {
+        s.append(reinterpret_cast<const char*>(v), count * 4);
+    } else {
+        for (size_t i = 0; i < count; ++i) PutU32(s, std::bit_cast<uint32_t>(v[i]));
+    }
+}
+
+template <typename T>
+static void GetArray(const char* p, T* v, size_t count) {
+    static_assert(sizeof(T) == 4);
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(v, p, count * 4);
+    } else {
+        for (size_t i = 0; i < count; ++i) v[i] = std::bit_cast<T>(static_cast<uint32_t>(GetLE(p + 4 * i, 4)));
+    }
+}
+
+std::filesystem::path CookedMeshPath(const std::filesystem::path& media_root, const std::string& source_hash) {
+    return media_root / ".cooked" / source_hash.substr(0, 2) / (source_hash + ".p4mesh");
+}
+
+std::filesystem::path CookedThumbnailPath(const std::filesystem::path& media_root, const std::string& scene_id) {
+    return media_root / ".cooked" / scene_id / "thumbnail.png";
+}
+
+bool EncodeCookedMesh(const std::vector<MeshData>& lods, const MeshStats& stats, const std::string& source_hash,
+                      std::string& out, std::string& error) {
+    if (lods.empty() || lods.size() > kMaxCookedLods) {
+        error = "LOD count out of range";
+        return false;
+    }
+    Sha256::Digest digest{};
+    if (!Sha256::IsHexDigest(source_hash)) {
+        error = "malformed source hash";
+        return false;
+    }
+    for (size_t i = 0; i < digest.size(); ++i) digest[i] = static_cast<uint8_t>(std::stoi(source_hash.substr(2 * i, 2), nullptr, 16));
+
+    out.clear();
+    out.append(kMagic, sizeof(kMagic));
+    PutU32(out, kCookedMeshVersion);
+    PutU32(out, static_cast<uint32_t>(lods.size()));
+    for (float v : stats.aabb_min) PutF32(out, v);
+    for (float v : stats.aabb_max) PutF32(out, v);
+    for (float v : stats.sphere_center) PutF32(out, v);
+    PutF32(out, stats.sphere_radius);
+    PutU64(out, stats.triangle_count);
+    out.append(reinterpret_cast<const char*>(digest.data()), digest.size());
+
+    uint64_t pos = AlignUp(kHeaderSize + kLodEntrySize * lods.size(), kDataAlignment);
+    for (const auto& lod : lods) {
+        if (lod.positions.size() % 3 != 0 || lod.positions.size() / 3 > UINT32_MAX || lod.indices.size() > UINT32_MAX) {
+            error = "LOD too large or malformed";
+            return false;
+        }
+        PutU32(out, static_cast<uint32_t>(lod.positions.size() / 3));
+        PutU32(out, static_cast<uint32_t>(lod.indices.size()));
+        PutU64(out, pos);
+        pos = AlignUp(pos + 4 * (lod.positions.size() + lod.indices.size()), kDataAlignment);
+    }
+    out.reserve(static_cast<size_t>(pos));
+    for (const auto& lod : lods) {
+        out.resize(static_cast<size_t>(AlignUp(out.size(), kDataAlignment)), '\0');
+        PutArray(out, lod.positions.data(), lod.positions.size());
+        PutArray(out, lod.indices.data(), lod.indices.size());
+    }
+    out.resize(static_cast<size_t>(pos), '\0');
+    return true;
+}
+
+bool ReadCookedMeshInfo(std::string_view data, CookedMeshInfo& out, std::string& error) {
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        error = "not a .p4mesh file";
+        return false;
+    }
+    const char* p = data.data();
+    out = CookedMeshInfo{};
+    out.version = static_cast<uint32_t>(GetLE(p + 8, 4));
+    if (out.version != kCookedMeshVersion) {
+        error = "unsupported .p4mesh version " + std::to_string(out.version);
+        return false;
+    }
+    uint32_t lod_count = static_cast<uint32_t>(GetLE(p + 12, 4));
+    if (lod_count == 0 || lod_count > kMaxCookedLods || data.size() < kHeaderSize + kLodEntrySize * lod_count) {
+        error = "bad LOD table";
+        return false;
+    }
+    const char* f = p + 16;
+    for (int k = 0; k < 3; ++k) out.stats.aabb_min[k] = GetF32(f + 4 * k);
+    for (int k = 0; k < 3; ++k) out.stats.aabb_max[k] = GetF32(f + 12 + 4 * k);
+    for (int k = 0; k < 3; ++k) out.stats.sphere_center[k] = GetF32(f + 24 + 4 * k);
+    out.stats.sphere_radius = GetF32(f + 36);
+    out.stats.triangle_count = GetLE(p + 56, 8);
+    Sha256::Digest digest;
+    std::memcpy(digest.data(), p + 64, digest.size());
+    out.source_hash = Sha256::ToHex(digest);
+
+    for (uint32_t i = 0; i < lod_count; ++i) {
+        const char* e = p + kHeaderSize + kLodEntrySize * i;
+        CookedMeshInfo::Lod lod;
+        lod.vertex_count = static_cast<uint32_t>(GetLE(e, 4));
+        lod.index_count = static_cast<uint32_t>(GetLE(e + 4, 4));
+        lod.offset = GetLE(e + 8, 8);
+        uint64_t bytes = 4 * (3 * uint64_t(lod.vertex_count) + lod.index_count);
+        if (lod.offset % kDataAlignment != 0 || lod.offset > data.size() || bytes > data.size() - lod.offset) {
+            error = "LOD " + std::to_string(i) + " outside the file";
+            return false;
+        }
+        out.lods.push_back(lod);
+    }
+    return true;
+}
+
+bool DecodeCookedMesh(std::string_view data, size_t lod, MeshData& out, std::string& error) {
+    CookedMeshInfo info;
+    if (!ReadCookedMeshInfo(data, info, error)) return false;
+    const CookedMeshInfo::Lod& l = info.lods[std::min(lod, info.lods.size() - 1)];
+    const char* p = data.data() + l.offset;
+    out.positions.resize(size_t(l.vertex_count) * 3);
+    out.indices.resize(l.index_count);
+    GetArray(p, out.positions.data(), out.positions.size());
+    GetArray(p + 4 * out.positions.size(), out.indices.data(), out.indices.size());
+    for (uint32_t idx : out.indices) {
+        if (idx >= l.vertex_count) {
+            error = "index out of range";
+            out.positions.clear();
+            out.indices.clear();
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "model_loader.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// .p4mesh: a model preprocessed by P4_Cook, so loading it is a bounds-checked memcpy instead of
+// a parse. Little-endian layout:
+//
+//   header (96 bytes)  magic "P4MESH01", u32 version, u32 LOD count, f32 aabb_min[3],
+//                      f32 aabb_max[3], f32 sphere_center[3], f32 sphere_radius,
+//                      u64 triangle count (LOD 0), 32-byte SHA-256 of the source file
+//   LOD table          per LOD: u32 vertex count, u32 index count, u64 offset
+//   LOD data           per LOD, 16-byte aligned: f32 positions[3 * vertices], u32 indices[]
+//
+// LOD 0 is the source mesh as ModelLoader decodes it, so its stats match a runtime parse; the
+// other LODs are progressively coarser. Bounds describe LOD 0.
+
+constexpr uint32_t kCookedMeshVersion = 1;
+constexpr size_t kMaxCookedLods = 8;
+
+struct CookedMeshInfo {
+    uint32_t version = 0;
+    MeshStats stats;
+    std::string source_hash; // hex SHA-256 of the source model file
+    struct Lod {
+        uint32_t vertex_count = 0;
+        uint32_t index_count = 0;
+        uint64_t offset = 0;
+    };
+    std::vector<Lod> lods;
+};
+
+// Where P4_Cook puts its output and the server looks for it: cooked models are keyed by the
+// source content, so a model shared between scenes is cooked once.
+//   <media_root>/.cooked/<first two hex digits>/<source hash>.p4mesh
+//   <media_root>/.cooked/<scene_id>/thumbnail.png
+std::filesystem::path CookedMeshPath(const std::filesystem::path& media_root, const std::string& source_hash);
+std::filesystem::path CookedThumbnailPath(const std::filesystem::path& media_root, const std::string& scene_id);
+
+// Serializes `lods` (LOD 0 first, at most kMaxCookedLods) into a .p4mesh.
+bool EncodeCookedMesh(const std::vector<MeshData>& lods, const MeshStats& stats, const std::string& source_hash,
+                      std::string& out, std::string& error);
+
+// Reads and validates the header and LOD table only (cheap; for manifests and incremental cooks).
+bool ReadCookedMeshInfo(std::string_view data, CookedMeshInfo& out, std::string& error);
+
+// Decodes one LOD (clamped to the coarsest available) into `out`.
+bool DecodeCookedMesh(std::string_view data, size_t lod, MeshData& out, std::string& error);
\ No newline at end of file
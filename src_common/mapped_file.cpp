@@ -0,0 +1,136 @@
+#include "mapped_file.h"
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& o) noexcept {
+    MoveFrom(o);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+    if (this != &o) {
+        Close();
+        MoveFrom(o);
+    }
+    return *this;
+}
+
+void MappedFile::MoveFrom(MappedFile& o) noexcept {
+    data_ = std::exchange(o.data_, nullptr);
+    size_ = std::exchange(o.size_, 0);
+    open_ = std::exchange(o.open_, false);
+#ifdef _WIN32
+    file_ = std::exchange(o.file_, nullptr);
+    mapping_ = std::exchange(o.mapping_, nullptr);
+#else
+    fd_ = std::exchange(o.fd_, -1);
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "[MappedFile] Failed to open " << path << " (error " << GetLastError() << ")\n";
+        return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        std::cerr << "[MappedFile] Failed to stat " << path << "\n";
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    size_ = static_cast<size_t>(size.QuadPart);
+    open_ = true;
+    if (size_ == 0) return true; // CreateFileMapping rejects empty files
+
+    mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        std::cerr << "[MappedFile] CreateFileMapping failed for " << path << "\n";
+        Close();
+        return false;
+    }
+    data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (!data_) {
+        std::cerr << "[MappedFile] MapViewOfFile failed for " << path << "\n";
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "[MappedFile] Failed to open " << path << "\n";
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        std::cerr << "[MappedFile] Failed to stat " << path << "\n";
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    size_ = static_cast<size_t>(st.st_size);
+    open_ = true;
+    if (size_ == 0) return true; // mmap rejects zero-length mappings
+
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        std::cerr << "[MappedFile] mmap failed for " << path << "\n";
+        Close();
+        return false;
+    }
+    // Meshes are decoded front to back in one pass.
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+    data_ = p;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) ::munmap(const_cast<void*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    fd_ = -1;
+    size_ = 0;
+    open_ = false;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Read-only memory map of a whole file (CreateFileMapping on Windows, mmap elsewhere).
+// Binary mesh formats are decoded straight from the mapping without an intermediate read buffer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& o) noexcept;
+    MappedFile& operator=(MappedFile&& o) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false (and logs) if the file can't be opened or mapped. Empty files map to an empty view.
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return open_; }
+    const uint8_t* Data() const { return static_cast<const uint8_t*>(data_); }
+    size_t Size() const { return size_; }
+    std::string_view View() const { return { static_cast<const char*>(data_), size_ }; }
+
+private:
+    void MoveFrom(MappedFile& o) noexcept;
+
+    const void* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;    // HANDLE
+    void* mapping_ = nullptr; // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
\ No newline at end of file
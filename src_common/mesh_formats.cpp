@@ -0,0 +1,584 @@
+#include "mesh_formats.h"
+#include "mini_json.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+// ---- byte helpers -------------------------------------------------------------------------------
+
+static uint16_t ByteSwap16(uint16_t v) { return uint16_t((v >> 8) | (v << 8)); }
+static uint32_t ByteSwap32(uint32_t v) {
+    return (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+}
+static uint64_t ByteSwap64(uint64_t v) {
+    return (uint64_t(ByteSwap32(uint32_t(v))) << 32) | ByteSwap32(uint32_t(v >> 32));
+}
+
+// Unaligned load of a T stored in the given byte order.
+template <typename T>
+static T Load(const uint8_t* p, bool little_endian = true) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    if constexpr (sizeof(T) > 1) {
+        if (little_endian != (std::endian::native == std::endian::little)) {
+            if constexpr (sizeof(T) == 2) { uint16_t u; std::memcpy(&u, &v, 2); u = ByteSwap16(u); std::memcpy(&v, &u, 2); }
+            if constexpr (sizeof(T) == 4) { uint32_t u; std::memcpy(&u, &v, 4); u = ByteSwap32(u); std::memcpy(&v, &u, 4); }
+            if constexpr (sizeof(T) == 8) { uint64_t u; std::memcpy(&u, &v, 8); u = ByteSwap64(u); std::memcpy(&v, &u, 8); }
+        }
+    }
+    return v;
+}
+
+static const uint8_t* Bytes(std::string_view data) { return reinterpret_cast<const uint8_t*>(data.data()); }
+
+// True if a run of little-endian floats can be copied as-is.
+static constexpr bool kNativeLittle = std::endian::native == std::endian::little;
+
+// ---- glTF binary --------------------------------------------------------------------------------
+
+namespace {
+
+constexpr uint32_t kGlbMagic = 0x46546C67;     // "glTF"
+constexpr uint32_t kGlbChunkJson = 0x4E4F534A; // "JSON"
+constexpr uint32_t kGlbChunkBin = 0x004E4942;  // "BIN\0"
+
+constexpr int kGltfUnsignedByte = 5121;
+constexpr int kGltfUnsignedShort = 5123;
+constexpr int kGltfUnsignedInt = 5125;
+constexpr int kGltfFloat = 5126;
+constexpr int kGltfTriangles = 4;
+constexpr int kGltfMaxNodeDepth = 64;
+
+// Column-major 4x4, as stored in glTF.
+struct Mat4 {
+    double m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    bool identity = true;
+};
+
+Mat4 Multiply(const Mat4& a, const Mat4& b) {
+    if (a.identity) return b;
+    if (b.identity) return a;
+    Mat4 r;
+    r.identity = false;
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) {
+            double sum = 0.0;
+            for (int k = 0; k < 4; ++k) sum += a.m[k * 4 + row] * b.m[c * 4 + k];
+            r.m[c * 4 + row] = sum;
+        }
+    }
+    return r;
+}
+
+Mat4 NodeLocalMatrix(const JsonValue& node) {
+    Mat4 r;
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.IsArray() && matrix.Size() == 16) {
+        for (size_t i = 0; i < 16; ++i) r.m[i] = matrix[i].AsNumber();
+        r.identity = false;
+        return r;
+    }
+    const JsonValue& t = node["translation"];
+    const JsonValue& q = node["rotation"];
+    const JsonValue& s = node["scale"];
+    if (t.IsNull() && q.IsNull() && s.IsNull()) return r;
+
+    double tx = t[0].AsNumber(), ty = t[1].AsNumber(), tz = t[2].AsNumber();
+    double x = q[0].AsNumber(), y = q[1].AsNumber(), z = q[2].AsNumber(), w = q[3].AsNumber(1.0);
+    double sx = s[0].AsNumber(1.0), sy = s[1].AsNumber(1.0), sz = s[2].AsNumber(1.0);
+
+    // T * R * S
+    r.m[0] = (1 - 2 * (y * y + z * z)) * sx;
+    r.m[1] = (2 * (x * y + z * w)) * sx;
+    r.m[2] = (2 * (x * z - y * w)) * sx;
+    r.m[4] = (2 * (x * y - z * w)) * sy;
+    r.m[5] = (1 - 2 * (x * x + z * z)) * sy;
+    r.m[6] = (2 * (y * z + x * w)) * sy;
+    r.m[8] = (2 * (x * z + y * w)) * sz;
+    r.m[9] = (2 * (y * z - x * w)) * sz;
+    r.m[10] = (1 - 2 * (x * x + y * y)) * sz;
+    r.m[12] = tx;
+    r.m[13] = ty;
+    r.m[14] = tz;
+    r.identity = false;
+    return r;
+}
+
+struct AccessorView {
+    const uint8_t* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int component_type = 0;
+    int components = 0;
+};
+
+int ComponentSize(int component_type) {
+    switch (component_type) {
+    case 5120: case kGltfUnsignedByte: return 1;
+    case 5122: case kGltfUnsignedShort: return 2;
+    case kGltfUnsignedInt: case kGltfFloat: return 4;
+    default: return 0;
+    }
+}
+
+int ComponentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT4") return 16;
+    return 0;
+}
+
+// Resolves accessor `index` to a bounds-checked strided view into the GLB BIN chunk.
+bool ResolveAccessor(const JsonValue& doc, std::string_view bin, int64_t index, AccessorView& out, std::string& error) {
+    const JsonValue& acc = doc["accessors"][size_t(index)];
+    if (index < 0 || !acc.IsObject()) { error = "accessor " + std::to_string(index) + " missing"; return false; }
+    if (acc.Has("sparse")) { error = "sparse accessors are not supported"; return false; }
+    if (!acc.Has("bufferView")) { error = "accessor without bufferView is not supported"; return false; }
+
+    const JsonValue& view = doc["bufferViews"][size_t(acc["bufferView"].AsInt(-1))];
+    if (!view.IsObject()) { error = "bufferView missing"; return false; }
+    const JsonValue& buffer = doc["buffers"][size_t(view["buffer"].AsInt(-1))];
+    if (!buffer.IsObject() || buffer.Has("uri")) { error = "only the embedded GLB buffer is supported"; return false; }
+
+    out.component_type = int(acc["componentType"].AsInt());
+    out.components = ComponentCount(acc["type"].AsString());
+    int comp_size = ComponentSize(out.component_type);
+    if (comp_size == 0 || out.components == 0) { error = "unsupported accessor layout"; return false; }
+
+    int64_t count = acc["count"].AsInt(-1);
+    int64_t view_offset = view["byteOffset"].AsInt(0);
+    int64_t view_length = view["byteLength"].AsInt(-1);
+    int64_t acc_offset = acc["byteOffset"].AsInt(0);
+    int64_t elem_size = int64_t(comp_size) * out.components;
+    int64_t stride = view["byteStride"].AsInt(0);
+    if (stride == 0) stride = elem_size;
+    if (count < 0 || view_offset < 0 || view_length < 0 || acc_offset < 0 || stride < elem_size) {
+        error = "invalid accessor/bufferView ranges";
+        return false;
+    }
+    if (uint64_t(view_offset) + uint64_t(view_length) > bin.size()) { error = "bufferView exceeds BIN chunk"; return false; }
+    if (count > 0 && uint64_t(acc_offset) + uint64_t(stride) * uint64_t(count - 1) + uint64_t(elem_size) > uint64_t(view_length)) {
+        error = "accessor exceeds its bufferView";
+        return false;
+    }
+    out.data = Bytes(bin) + view_offset + acc_offset;
+    out.count = size_t(count);
+    out.stride = size_t(stride);
+    return true;
+}
+
+// One primitive to emit, with the world transform of the node that references its mesh.
+struct GltfDraw {
+    Mat4 transform;
+    AccessorView positions;
+    AccessorView indices; // data == nullptr when non-indexed
+    size_t index_count;
+};
+
+void CollectMesh(const JsonValue& mesh, const Mat4& transform, std::vector<const JsonValue*>& prims, std::vector<Mat4>& xforms) {
+    const JsonValue& primitives = mesh["primitives"];
+    for (size_t p = 0; p < primitives.Size(); ++p) {
+        const JsonValue& prim = primitives[p];
+        if (prim["mode"].AsInt(kGltfTriangles) != kGltfTriangles) continue; // points/lines/strips skipped
+        prims.push_back(&prim);
+        xforms.push_back(transform);
+    }
+}
+
+void CollectNode(const JsonValue& doc, int64_t node_index, const Mat4& parent, int depth,
+                 std::vector<const JsonValue*>& prims, std::vector<Mat4>& xforms) {
+    const JsonValue& node = doc["nodes"][size_t(node_index)];
+    if (node_index < 0 || !node.IsObject() || depth > kGltfMaxNodeDepth) return;
+    Mat4 world = Multiply(parent, NodeLocalMatrix(node));
+    if (node.Has("mesh")) {
+        const JsonValue& mesh = doc["meshes"][size_t(node["mesh"].AsInt(-1))];
+        if (mesh.IsObject()) CollectMesh(mesh, world, prims, xforms);
+    }
+    const JsonValue& children = node["children"];
+    for (size_t c = 0; c < children.Size(); ++c) {
+        CollectNode(doc, children[c].AsInt(-1), world, depth + 1, prims, xforms);
+    }
+}
+
+} // namespace
+
+bool DecodeGLB(std::string_view data, MeshData& out, std::string& error) {
+    const uint8_t* p = Bytes(data);
+    if (data.size() < 20 || Load<uint32_t>(p) != kGlbMagic) { error = "not a GLB file"; return false; }
+    if (Load<uint32_t>(p + 4) != 2) { error = "unsupported glTF version"; return false; }
+    size_t total = Load<uint32_t>(p + 8);
+    if (total > data.size()) { error = "truncated GLB"; return false; }
+
+    std::string_view json_chunk, bin_chunk;
+    for (size_t off = 12; off + 8 <= total;) {
+        size_t len = Load<uint32_t>(p + off);
+        uint32_t type = Load<uint32_t>(p + off + 4);
+        off += 8;
+        if (len > total - off) { error = "GLB chunk exceeds file"; return false; }
+        if (type == kGlbChunkJson && json_chunk.empty()) json_chunk = data.substr(off, len);
+        else if (type == kGlbChunkBin && bin_chunk.empty()) bin_chunk = data.substr(off, len);
+        off += (len + 3) & ~size_t(3);
+    }
+    if (json_chunk.empty()) { error = "GLB has no JSON chunk"; return false; }
+
+    JsonValue doc;
+    std::string json_error;
+    if (!JsonValue::Parse(json_chunk, doc, &json_error)) { error = "glTF JSON: " + json_error; return false; }
+
+    // Default scene's node hierarchy if there is one; otherwise every mesh once, untransformed.
+    std::vector<const JsonValue*> prims;
+    std::vector<Mat4> xforms;
+    const JsonValue& scene = doc["scenes"][size_t(doc["scene"].AsInt(0))];
+    if (scene.IsObject() && doc["nodes"].IsArray()) {
+        const JsonValue& roots = scene["nodes"];
+        for (size_t r = 0; r < roots.Size(); ++r) CollectNode(doc, roots[r].AsInt(-1), Mat4{}, 0, prims, xforms);
+    } else {
+        const JsonValue& meshes = doc["meshes"];
+        for (size_t m = 0; m < meshes.Size(); ++m) CollectMesh(meshes[m], Mat4{}, prims, xforms);
+    }
+
+    // Resolve and size everything first so the buffers are allocated exactly once.
+    std::vector<GltfDraw> draws;
+    draws.reserve(prims.size());
+    uint64_t vertex_total = 0, index_total = 0;
+    for (size_t i = 0; i < prims.size(); ++i) {
+        const JsonValue& prim = *prims[i];
+        GltfDraw d{ xforms[i], {}, {}, 0 };
+        if (!prim["attributes"].Has("POSITION")) continue;
+        if (!ResolveAccessor(doc, bin_chunk, prim["attributes"]["POSITION"].AsInt(-1), d.positions, error)) return false;
+        if (d.positions.component_type != kGltfFloat || d.positions.components != 3) {
+            error = "POSITION must be float VEC3 (quantized meshes are not supported)";
+            return false;
+        }
+        if (prim.Has("indices")) {
+            if (!ResolveAccessor(doc, bin_chunk, prim["indices"].AsInt(-1), d.indices, error)) return false;
+            if (d.indices.components != 1 || (d.indices.component_type != kGltfUnsignedByte &&
+                d.indices.component_type != kGltfUnsignedShort && d.indices.component_type != kGltfUnsignedInt)) {
+                error = "unsupported index accessor";
+                return false;
+            }
+            d.index_count = d.indices.count - d.indices.count % 3;
+        } else {
+            d.index_count = d.positions.count - d.positions.count % 3;
+        }
+        vertex_total += d.positions.count;
+        index_total += d.index_count;
+        draws.push_back(d);
+    }
+    if (vertex_total > std::numeric_limits<uint32_t>::max()) { error = "mesh too large for 32-bit indices"; return false; }
+
+    out.positions.resize(size_t(vertex_total) * 3);
+    out.indices.resize(size_t(index_total));
+    float* pos = out.positions.data();
+    uint32_t* ind = out.indices.data();
+    uint32_t base = 0;
+
+    for (const GltfDraw& d : draws) {
+        const AccessorView& pv = d.positions;
+        if (d.transform.identity && pv.stride == 12 && kNativeLittle) {
+            std::memcpy(pos, pv.data, pv.count * 12);
+            pos += pv.count * 3;
+        } else {
+            const double* m = d.transform.m;
+            for (size_t v = 0; v < pv.count; ++v) {
+                const uint8_t* src = pv.data + v * pv.stride;
+                float x = Load<float>(src), y = Load<float>(src + 4), z = Load<float>(src + 8);
+                if (d.transform.identity) {
+                    *pos++ = x; *pos++ = y; *pos++ = z;
+                } else {
+                    *pos++ = float(m[0] * x + m[4] * y + m[8] * z + m[12]);
+                    *pos++ = float(m[1] * x + m[5] * y + m[9] * z + m[13]);
+                    *pos++ = float(m[2] * x + m[6] * y + m[10] * z + m[14]);
+                }
+            }
+        }
+
+        const AccessorView& iv = d.indices;
+        for (size_t k = 0; k < d.index_count; ++k) {
+            uint32_t idx;
+            if (!iv.data) idx = uint32_t(k);
+            else if (iv.component_type == kGltfUnsignedByte) idx = iv.data[k * iv.stride];
+            else if (iv.component_type == kGltfUnsignedShort) idx = Load<uint16_t>(iv.data + k * iv.stride);
+            else idx = Load<uint32_t>(iv.data + k * iv.stride);
+            if (idx >= pv.count) { error = "index out of range"; return false; }
+            *ind++ = base + idx;
+        }
+        base += uint32_t(pv.count);
+    }
+    return true;
+}
+
+// ---- binary PLY ---------------------------------------------------------------------------------
+
+namespace {
+
+enum class PlyType { Invalid, Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+struct PlyProperty {
+    std::string name;
+    PlyType type = PlyType::Invalid;       // element type (list entries for lists)
+    PlyType count_type = PlyType::Invalid; // list length type; Invalid for scalars
+    bool IsList() const { return count_type != PlyType::Invalid; }
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count = 0;
+    std::vector<PlyProperty> props;
+};
+
+PlyType ParsePlyType(const std::string& s) {
+    if (s == "char" || s == "int8") return PlyType::Int8;
+    if (s == "uchar" || s == "uint8") return PlyType::UInt8;
+    if (s == "short" || s == "int16") return PlyType::Int16;
+    if (s == "ushort" || s == "uint16") return PlyType::UInt16;
+    if (s == "int" || s == "int32") return PlyType::Int32;
+    if (s == "uint" || s == "uint32") return PlyType::UInt32;
+    if (s == "float" || s == "float32") return PlyType::Float32;
+    if (s == "double" || s == "float64") return PlyType::Float64;
+    return PlyType::Invalid;
+}
+
+size_t PlyTypeSize(PlyType t) {
+    switch (t) {
+    case PlyType::Int8: case PlyType::UInt8: return 1;
+    case PlyType::Int16: case PlyType::UInt16: return 2;
+    case PlyType::Int32: case PlyType::UInt32: case PlyType::Float32: return 4;
+    case PlyType::Float64: return 8;
+    default: return 0;
+    }
+}
+
+double ReadPlyNumber(const uint8_t* p, PlyType t, bool le) {
+    switch (t) {
+    case PlyType::Int8: return double(int8_t(*p));
+    case PlyType::UInt8: return double(*p);
+    case PlyType::Int16: return double(Load<int16_t>(p, le));
+    case PlyType::UInt16: return double(Load<uint16_t>(p, le));
+    case PlyType::Int32: return double(Load<int32_t>(p, le));
+    case PlyType::UInt32: return double(Load<uint32_t>(p, le));
+    case PlyType::Float32: return double(Load<float>(p, le));
+    case PlyType::Float64: return Load<double>(p, le);
+    default: return 0.0;
+    }
+}
+
+int64_t ReadPlyInt(const uint8_t* p, PlyType t, bool le) {
+    switch (t) {
+    case PlyType::Int8: return int8_t(*p);
+    case PlyType::UInt8: return *p;
+    case PlyType::Int16: return Load<int16_t>(p, le);
+    case PlyType::UInt16: return Load<uint16_t>(p, le);
+    case PlyType::Int32: return Load<int32_t>(p, le);
+    case PlyType::UInt32: return Load<uint32_t>(p, le);
+    default: return -1; // float list counts/indices are rejected
+    }
+}
+
+// Splits one header line into whitespace-separated words.
+std::vector<std::string> SplitWords(std::string_view line) {
+    std::vector<std::string> words;
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+        size_t start = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') ++i;
+        if (i > start) words.emplace_back(line.substr(start, i - start));
+    }
+    return words;
+}
+
+// Byte size of one record when the element has no list properties, else 0.
+size_t FixedRecordSize(const PlyElement& el) {
+    size_t size = 0;
+    for (const auto& p : el.props) {
+        if (p.IsList()) return 0;
+        size += PlyTypeSize(p.type);
+    }
+    return size;
+}
+
+} // namespace
+
+bool DecodePLY(std::string_view data, MeshData& out, std::string& error) {
+    if (data.substr(0, 4) != "ply\n" && data.substr(0, 5) != "ply\r\n") { error = "not a PLY file"; return false; }
+
+    // Header
+    std::vector<PlyElement> elements;
+    bool little_endian = true;
+    bool have_format = false;
+    size_t pos = 0;
+    size_t body = std::string_view::npos;
+    while (pos < data.size()) {
+        size_t eol = data.find('\n', pos);
+        if (eol == std::string_view::npos) break;
+        std::vector<std::string> w = SplitWords(data.substr(pos, eol - pos));
+        pos = eol + 1;
+        if (w.empty() || w[0] == "ply" || w[0] == "comment" || w[0] == "obj_info") continue;
+        if (w[0] == "end_header") { body = pos; break; }
+        if (w[0] == "format" && w.size() >= 2) {
+            if (w[1] == "binary_little_endian") little_endian = true;
+            else if (w[1] == "binary_big_endian") little_endian = false;
+            else { error = "text PLY is not supported; export as binary"; return false; }
+            have_format = true;
+        } else if (w[0] == "element" && w.size() >= 3) {
+            PlyElement el;
+            el.name = w[1];
+            el.count = size_t(std::strtoull(w[2].c_str(), nullptr, 10));
+            elements.push_back(std::move(el));
+        } else if (w[0] == "property" && !elements.empty()) {
+            PlyProperty prop;
+            if (w.size() >= 5 && w[1] == "list") {
+                prop.count_type = ParsePlyType(w[2]);
+                prop.type = ParsePlyType(w[3]);
+                prop.name = w[4];
+                if (prop.count_type == PlyType::Invalid) { error = "bad PLY list count type"; return false; }
+            } else if (w.size() >= 3) {
+                prop.type = ParsePlyType(w[1]);
+                prop.name = w[2];
+            }
+            if (prop.type == PlyType::Invalid) { error = "bad PLY property type"; return false; }
+            elements.back().props.push_back(std::move(prop));
+        }
+    }
+    if (body == std::string_view::npos || !have_format) { error = "incomplete PLY header"; return false; }
+
+    const uint8_t* p = Bytes(data) + body;
+    const uint8_t* end = Bytes(data) + data.size();
+    size_t vertex_count = 0;
+    bool have_vertices = false;
+    out.indices.clear();
+
+    for (const PlyElement& el : elements) {
+        size_t fixed = FixedRecordSize(el);
+
+        if (el.name == "vertex") {
+            int xi = -1, yi = -1, zi = -1;
+            std::vector<size_t> offsets(el.props.size(), 0);
+            size_t off = 0;
+            for (size_t i = 0; i < el.props.size(); ++i) {
+                offsets[i] = off;
+                off += PlyTypeSize(el.props[i].type);
+                if (el.props[i].name == "x") xi = int(i);
+                else if (el.props[i].name == "y") yi = int(i);
+                else if (el.props[i].name == "z") zi = int(i);
+            }
+            if (xi < 0 || yi < 0 || zi < 0 || fixed == 0) { error = "PLY vertex element needs scalar x, y, z"; return false; }
+            if (size_t(end - p) / fixed < el.count) { error = "truncated PLY vertex data"; return false; }
+
+            vertex_count = el.count;
+            have_vertices = true;
+            out.positions.resize(vertex_count * 3);
+            float* dst = out.positions.data();
+            const PlyType tx = el.props[xi].type, ty = el.props[yi].type, tz = el.props[zi].type;
+            bool packed = fixed == 12 && offsets[xi] == 0 && offsets[yi] == 4 && offsets[zi] == 8 &&
+                          tx == PlyType::Float32 && ty == PlyType::Float32 && tz == PlyType::Float32;
+            if (packed && little_endian == kNativeLittle) {
+                std::memcpy(dst, p, vertex_count * 12);
+            } else {
+                for (size_t v = 0; v < vertex_count; ++v) {
+                    const uint8_t* rec = p + v * fixed;
+                    *dst++ = float(ReadPlyNumber(rec + offsets[xi], tx, little_endian));
+                    *dst++ = float(ReadPlyNumber(rec + offsets[yi], ty, little_endian));
+                    *dst++ = float(ReadPlyNumber(rec + offsets[zi], tz, little_endian));
+                }
+            }
+            p += vertex_count * fixed;
+            continue;
+        }
+
+        if (fixed != 0) {
+            if (size_t(end - p) / fixed < el.count) { error = "truncated PLY element data"; return false; }
+            p += el.count * fixed;
+            continue;
+        }
+
+        // Elements with list properties have to be walked record by record.
+        bool is_face = el.name == "face";
+        auto is_index_list = [&](const PlyProperty& prop) {
+            return is_face && prop.IsList() && (prop.name == "vertex_indices" || prop.name == "vertex_index");
+        };
+        // The count comes from the header, so check it against the smallest possible records
+        // (every list empty) before sizing anything by it.
+        size_t min_record = 0, min_triangle_record = 0;
+        for (const PlyProperty& prop : el.props) {
+            min_record += PlyTypeSize(prop.IsList() ? prop.count_type : prop.type);
+            if (is_index_list(prop)) min_triangle_record += 3 * PlyTypeSize(prop.type);
+        }
+        min_triangle_record += min_record;
+        if (size_t(end - p) / min_record < el.count) { error = "truncated PLY element data"; return false; }
+        if (is_face) out.indices.reserve(out.indices.size() + std::min(el.count, size_t(end - p) / min_triangle_record) * 3);
+        for (size_t r = 0; r < el.count; ++r) {
+            for (const PlyProperty& prop : el.props) {
+                size_t item = PlyTypeSize(prop.type);
+                if (!prop.IsList()) {
+                    if (size_t(end - p) < item) { error = "truncated PLY element data"; return false; }
+                    p += item;
+                    continue;
+                }
+                size_t count_size = PlyTypeSize(prop.count_type);
+                if (size_t(end - p) < count_size) { error = "truncated PLY list"; return false; }
+                int64_t n = ReadPlyInt(p, prop.count_type, little_endian);
+                p += count_size;
+                if (n < 0 || size_t(end - p) / item < size_t(n)) { error = "truncated PLY list"; return false; }
+                bool indices = is_index_list(prop);
+                if (indices && n >= 3) {
+                    // Fan triangulation: (0, i, i+1)
+                    int64_t first = ReadPlyInt(p, prop.type, little_endian);
+                    int64_t prev = ReadPlyInt(p + item, prop.type, little_endian);
+                    for (int64_t i = 2; i < n; ++i) {
+                        int64_t cur = ReadPlyInt(p + size_t(i) * item, prop.type, little_endian);
+                        if (first < 0 || prev < 0 || cur < 0) { error = "invalid PLY face index"; return false; }
+                        out.indices.push_back(uint32_t(first));
+                        out.indices.push_back(uint32_t(prev));
+                        out.indices.push_back(uint32_t(cur));
+                        prev = cur;
+                    }
+                }
+                p += size_t(n) * item;
+            }
+        }
+    }
+
+    if (!have_vertices) { error = "PLY has no vertex element"; return false; }
+    // Validated at the end because the face element may precede the vertex element.
+    for (uint32_t idx : out.indices) {
+        if (idx >= vertex_count) { error = "PLY face index out of range"; return false; }
+    }
+    return true;
+}
+
+// ---- binary STL ---------------------------------------------------------------------------------
+
+bool DecodeSTL(std::string_view data, MeshData& out, std::string& error) {
+    if (data.size() < 84) { error = "truncated STL"; return false; }
+    const uint8_t* p = Bytes(data);
+    uint64_t tri_count = Load<uint32_t>(p + 80);
+    if (84 + tri_count * 50 > data.size()) {
+        error = data.substr(0, 5) == "solid" ? "ASCII STL is not supported; export as binary" : "truncated STL";
+        return false;
+    }
+
+    out.positions.resize(size_t(tri_count) * 9);
+    out.indices.resize(size_t(tri_count) * 3);
+    float* pos = out.positions.data();
+    const uint8_t* rec = p + 84;
+    for (uint64_t t = 0; t < tri_count; ++t, rec += 50) {
+        // 12 bytes facet normal (ignored), 36 bytes of vertices, 2 bytes attributes.
+        if constexpr (kNativeLittle) {
+            std::memcpy(pos, rec + 12, 36);
+            pos += 9;
+        } else {
+            for (int k = 0; k < 9; ++k) *pos++ = Load<float>(rec + 12 + k * 4);
+        }
+    }
+    for (uint32_t i = 0; i < uint32_t(out.indices.size()); ++i) out.indices[i] = i;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "model_loader.h"
+#include <string>
+#include <string_view>
+
+// Binary mesh decoders. Each one reads positions and triangle indices straight out of the file
+// bytes (typically a MappedFile view or a downloaded buffer) into MeshData: position arrays that
+// are already tightly packed little-endian floats are copied with a single memcpy, everything
+// else is converted per vertex without any text parsing. Only positions are extracted, matching
+// the OBJ path. On failure they return false and describe the problem in `error`.
+
+// glTF 2.0 binary container (.glb). Triangle primitives (mode 4) of every mesh are merged; node
+// transforms of the default scene are baked in. Only the embedded BIN buffer is supported.
+bool DecodeGLB(std::string_view data, MeshData& out, std::string& error);
+
+// Binary PLY (little- or big-endian). Reads vertex x/y/z and fan-triangulates face index lists.
+bool DecodePLY(std::string_view data, MeshData& out, std::string& error);
+
+// Binary STL: 80-byte header, triangle count, 50 bytes per triangle. Vertices are not welded.
+bool DecodeSTL(std::string_view data, MeshData& out, std::string& error);
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "mini_json.h"
+#include <charconv>
+
+namespace {
+const JsonValue kNull{};
+const std::string kEmpty;
+constexpr int kMaxDepth = 64;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+    if (type_ != Type::Object) return kNull;
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] == key) return items_[i];
+    }
+    return kNull;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+    if (type_ != Type::Array || index >= items_.size()) return kNull;
+    return items_[index];
+}
+
+const std::string& JsonValue::AsString() const {
+    return type_ == Type::String ? string_ : kEmpty;
+}
+
+// Recursive-descent parser over a string_view.
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : s_(text) {}
+
+    bool ParseDocument(JsonValue& out) {
+        if (!ParseValue(out, 0)) return false;
+        SkipWs();
+        if (pos_ != s_.size()) return Fail("trailing characters");
+        return true;
+    }
+
+    std::string error;
+
+private:
+    bool Fail(const char* what) {
+        if (error.empty()) error = std::string(what) + " at offset " + std::to_string(pos_);
+        return false;
+    }
+
+    void SkipWs() {
+        while (pos_ < s_.size() && (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\n' || s_[pos_] == '\r')) ++pos_;
+    }
+
+    bool Consume(char c) {
+        SkipWs();
+        if (pos_ < s_.size() && s_[pos_] == c) { ++pos_; return true; }
+        return false;
+    }
+
+    bool Literal(std::string_view word) {
+        if (s_.substr(pos_, word.size()) != word) return Fail("invalid literal");
+        pos_ += word.size();
+        return true;
+    }
+
+    bool ParseValue(JsonValue& out, int depth) {
+        if (depth > kMaxDepth) return Fail("nesting too deep");
+        SkipWs();
+        if (pos_ >= s_.size()) return Fail("unexpected end of input");
+        char c = s_[pos_];
+        switch (c) {
+        case '{': return ParseObject(out, depth);
+        case '[': return ParseArray(out, depth);
+        case '"': out.type_ = JsonValue::Type::String; return ParseString(out.string_);
+        case 't': out.type_ = JsonValue::Type::Bool; out.bool_ = true; return Literal("true");
+        case 'f': out.type_ = JsonValue::Type::Bool; out.bool_ = false; return Literal("false");
+        case 'n': out.type_ = JsonValue::Type::Null; return Literal("null");
+        default: return ParseNumber(out);
+        }
+    }
+
+    bool ParseObject(JsonValue& out, int depth) {
+        out.type_ = JsonValue::Type::Object;
+        ++pos_; // '{'
+        if (Consume('}')) return true;
+        do {
+            SkipWs();
+            if (pos_ >= s_.size() || s_[pos_] != '"') return Fail("expected object key");
+            std::string key;
+            if (!ParseString(key)) return false;
+            if (!Consume(':')) return Fail("expected ':'");
+            out.keys_.push_back(std::move(key));
+            out.items_.emplace_back();
+            if (!ParseValue(out.items_.back(), depth + 1)) return false;
+        } while (Consume(','));
+        if (!Consume('}')) return Fail("expected '}'");
+        return true;
+    }
+
+    bool ParseArray(JsonValue& out, int depth) {
+        out.type_ = JsonValue::Type::Array;
+        ++pos_; // '['
+        if (Consume(']')) return true;
+        do {
+            out.items_.emplace_back();
+            if (!ParseValue(out.items_.back(), depth + 1)) return false;
+        } while (Consume(','));
+        if (!Consume(']')) return Fail("expected ']'");
+        return true;
+    }
+
+    bool ParseNumber(JsonValue& out) {
+        size_t start = pos_;
+        if (pos_ < s_.size() && s_[pos_] == '-') ++pos_;
+        while (pos_ < s_.size()) {
+            char c = s_[pos_];
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') ++pos_;
+            else break;
+        }
+        if (pos_ == start) return Fail("unexpected character");
+        const char* first = s_.data() + start;
+        const char* last = s_.data() + pos_;
+        auto [ptr, ec] = std::from_chars(first, last, out.number_);
+        if (ec != std::errc() || ptr != last) return Fail("invalid number");
+        out.type_ = JsonValue::Type::Number;
+        return true;
+    }
+
+    bool ParseHex4(uint32_t& cp) {
+        if (pos_ + 4 > s_.size()) return Fail("truncated \\u escape");
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = s_[pos_++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= uint32_t(c - '0');
+            else if (c >= 'a' && c <= 'f') cp |= uint32_t(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') cp |= uint32_t(c - 'A' + 10);
+            else return Fail("invalid \\u escape");
+        }
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += char(cp);
+        } else if (cp < 0x800) {
+            out += char(0xC0 | (cp >> 6));
+            out += char(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += char(0xE0 | (cp >> 12));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        } else {
+            out += char(0xF0 | (cp >> 18));
+            out += char(0x80 | ((cp >> 12) & 0x3F));
+            out += char(0x80 | ((cp >> 6) & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ParseString(std::string& out) {
+        ++pos_; // opening quote
+        while (pos_ < s_.size()) {
+            char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') { out += c; continue; }
+            if (pos_ >= s_.size()) break;
+            char e = s_[pos_++];
+            switch (e) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!ParseHex4(cp)) return false;
+                // Combine a UTF-16 surrogate pair; a lone surrogate is kept as-is.
+                if (cp >= 0xD800 && cp <= 0xDBFF && s_.substr(pos_, 2) == "\\u") {
+                    size_t save = pos_;
+                    pos_ += 2;
+                    uint32_t lo = 0;
+                    if (!ParseHex4(lo)) return false;
+                    if (lo >= 0xDC00 && lo <= 0xDFFF) cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    else pos_ = save;
+                }
+                AppendUtf8(out, cp);
+                break;
+            }
+            default: return Fail("invalid escape");
+            }
+        }
+        return Fail("unterminated string");
+    }
+
+    std::string_view s_;
+    size_t pos_ = 0;
+};
+
+bool JsonValue::Parse(std::string_view text, JsonValue& out, std::string* error) {
+    out = JsonValue{};
+    JsonParser parser(text);
+    if (!parser.ParseDocument(out)) {
+        if (error) *error = parser.error;
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
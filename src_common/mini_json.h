@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Small read-only JSON DOM, just enough for glTF headers. Not a general-purpose library:
+// numbers are doubles, objects keep insertion order and lookups are linear.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type GetType() const { return type_; }
+    bool IsNull() const { return type_ == Type::Null; }
+    bool IsNumber() const { return type_ == Type::Number; }
+    bool IsString() const { return type_ == Type::String; }
+    bool IsArray() const { return type_ == Type::Array; }
+    bool IsObject() const { return type_ == Type::Object; }
+
+    // Missing keys / out-of-range indices / wrong types yield a shared null value, so lookups chain safely.
+    const JsonValue& operator[](std::string_view key) const;
+    const JsonValue& operator[](size_t index) const;
+    bool Has(std::string_view key) const { return !(*this)[key].IsNull(); }
+
+    // Array length or object member count; 0 for scalars.
+    size_t Size() const { return items_.size(); }
+
+    bool AsBool(bool fallback = false) const { return type_ == Type::Bool ? bool_ : fallback; }
+    double AsNumber(double fallback = 0.0) const { return type_ == Type::Number ? number_ : fallback; }
+    int64_t AsInt(int64_t fallback = 0) const { return type_ == Type::Number ? static_cast<int64_t>(number_) : fallback; }
+    const std::string& AsString() const;
+
+    // Parses a complete document. On failure returns false and describes the error in `error`.
+    static bool Parse(std::string_view text, JsonValue& out, std::string* error = nullptr);
+
+private:
+    friend class JsonParser;
+
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<std::string> keys_;  // object member names, parallel to items_
+    std::vector<JsonValue> items_;   // array elements or object member values
+};
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "model_loader.h"
+#include "mesh_formats.h"
+#include "mapped_file.h"
+#include <tiny_obj_loader.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+MeshStats ComputeMeshStats(const MeshData& mesh) {
+    MeshStats stats;
+    stats.triangle_count = mesh.indices.size() / 3;
+    size_t n = mesh.positions.size() / 3;
+    if (n == 0) return stats;
+
+    const float* p = mesh.positions.data();
+    for (int k = 0; k < 3; ++k) stats.aabb_min[k] = stats.aabb_max[k] = p[k];
+    for (size_t v = 1; v < n; ++v) {
+        for (int k = 0; k < 3; ++k) {
+            stats.aabb_min[k] = std::min(stats.aabb_min[k], p[v * 3 + k]);
+            stats.aabb_max[k] = std::max(stats.aabb_max[k], p[v * 3 + k]);
+        }
+    }
+    for (int k = 0; k < 3; ++k) stats.sphere_center[k] = 0.5f * (stats.aabb_min[k] + stats.aabb_max[k]);
+
+    float max_d2 = 0.0f;
+    for (size_t v = 0; v < n; ++v) {
+        float dx = p[v * 3 + 0] - stats.sphere_center[0];
+        float dy = p[v * 3 + 1] - stats.sphere_center[1];
+        float dz = p[v * 3 + 2] - stats.sphere_center[2];
+        max_d2 = std::max(max_d2, dx * dx + dy * dy + dz * dz);
+    }
+    stats.sphere_radius = std::sqrt(max_d2);
+    return stats;
+}
+
+// Flattens tinyobj shapes into a triangle list of positions (normals/uvs ignored for now).
+// A counting pass sizes both buffers exactly, so the fill pass never reallocates.
+static void FlattenShapes(const tinyobj::ObjReader& reader, MeshData& out, float scale) {
+    const auto& attrib = reader.GetAttrib();
+    const auto& shapes = reader.GetShapes();
+
+    size_t corner_count = 0;
+    for (const auto& shape : shapes) {
+        for (const auto& idx : shape.mesh.indices) {
+            if (idx.vertex_index >= 0) ++corner_count;
+        }
+    }
+
+    out.positions.resize(corner_count * 3);
+    out.indices.resize(corner_count);
+
+    float* pos = out.positions.data();
+    uint32_t* ind = out.indices.data();
+    uint32_t next = 0;
+    for (const auto& shape : shapes) {
+        for (const auto& idx : shape.mesh.indices) {
+            int vi = idx.vertex_index;
+            if (vi < 0) continue;
+            *pos++ = attrib.vertices[vi * 3 + 0] * scale;
+            *pos++ = attrib.vertices[vi * 3 + 1] * scale;
+            *pos++ = attrib.vertices[vi * 3 + 2] * scale;
+            *ind++ = next++;
+        }
+    }
+}
+
+static void LogReaderFailure(const tinyobj::ObjReader& reader, const std::string& what) {
+    std::cerr << "ModelLoader: tinyobj parse failed: " << what << "\n";
+    if (!reader.Warning().empty()) std::cerr << "Warning: " << reader.Warning() << "\n";
+    if (!reader.Error().empty()) std::cerr << "Error: " << reader.Error() << "\n";
+}
+
+// LoadOBJToMeshData: parse .obj into interleaved positions and triangle indices.
+// This flattens faces into a triangle list; normals/uvs ignored for now.
+bool ModelLoader::LoadOBJToMeshData(const std::string& path, MeshData& out, float scale, int artificial_ms_delay) const {
+    tinyobj::ObjReaderConfig cfg;
+    cfg.mtl_search_path = "";
+    tinyobj::ObjReader reader;
+    if (!reader.ParseFromFile(path, cfg)) {
+        LogReaderFailure(reader, path);
+        return false;
+    }
+
+    FlattenShapes(reader, out, scale);
+
+    if (artificial_ms_delay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(artificial_ms_delay));
+    }
+
+    return true;
+}
+
+// LoadOBJFromMemory: same as above, but materials are not resolved (no mtl text is streamed).
+bool ModelLoader::LoadOBJFromMemory(const std::string& obj_text, MeshData& out, float scale, int artificial_ms_delay) const {
+    tinyobj::ObjReaderConfig cfg;
+    cfg.mtl_search_path = "";
+    tinyobj::ObjReader reader;
+    if (!reader.ParseFromString(obj_text, std::string(), cfg)) {
+        LogReaderFailure(reader, "<memory>");
+        return false;
+    }
+
+    FlattenShapes(reader, out, scale);
+
+    if (artificial_ms_delay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(artificial_ms_delay));
+    }
+
+    return true;
+}
+
+MeshFormat ModelLoader::FormatFromName(std::string_view name) {
+    size_t dot = name.find_last_of('.');
+    if (dot == std::string_view::npos) return MeshFormat::Unknown;
+    std::string ext(name.substr(dot + 1));
+    for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (ext == "obj") return MeshFormat::Obj;
+    if (ext == "glb") return MeshFormat::Glb;
+    if (ext == "ply") return MeshFormat::Ply;
+    if (ext == "stl") return MeshFormat::Stl;
+    return MeshFormat::Unknown;
+}
+
+// Decodes one of the binary formats, then applies scale (only when needed) and the artificial delay.
+static bool DecodeBinaryMesh(MeshFormat format, std::string_view data, std::string_view name, MeshData& out, float scale, int artificial_ms_delay) {
+    std::string error;
+    bool ok = false;
+    switch (format) {
+    case MeshFormat::Glb: ok = DecodeGLB(data, out, error); break;
+    case MeshFormat::Ply: ok = DecodePLY(data, out, error); break;
+    case MeshFormat::Stl: ok = DecodeSTL(data, out, error); break;
+    default: error = "unsupported format"; break;
+    }
+    if (!ok) {
+        std::cerr << "ModelLoader: failed to decode " << name << ": " << error << "\n";
+        out.positions.clear();
+        out.indices.clear();
+        return false;
+    }
+
+    if (scale != 1.0f) {
+        for (float& v : out.positions) v *= scale;
+    }
+
+    if (artificial_ms_delay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(artificial_ms_delay));
+    }
+
+    return true;
+}
+
+bool ModelLoader::LoadMeshFile(const std::string& path, MeshData& out, float scale, int artificial_ms_delay) const {
+    MeshFormat format = FormatFromName(path);
+    if (format == MeshFormat::Obj) return LoadOBJToMeshData(path, out, scale, artificial_ms_delay);
+    if (format == MeshFormat::Unknown) {
+        std::cerr << "ModelLoader: unsupported mesh format: " << path << "\n";
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.Open(path)) return false;
+    return DecodeBinaryMesh(format, file.View(), path, out, scale, artificial_ms_delay);
+}
+
+bool ModelLoader::LoadMeshFromMemory(std::string_view data, std::string_view name, MeshData& out, float scale, int artificial_ms_delay) const {
+    MeshFormat format = FormatFromName(name);
+    // tinyobj parses from a std::string, so OBJ (the text fallback) pays for one copy here.
+    if (format == MeshFormat::Obj) return LoadOBJFromMemory(std::string(data), out, scale, artificial_ms_delay);
+    if (format == MeshFormat::Unknown) {
+        std::cerr << "ModelLoader: unsupported mesh format: " << name << "\n";
+        return false;
+    }
+    return DecodeBinaryMesh(format, data, name, out, scale, artificial_ms_delay);
+}
\ No newline at end of file
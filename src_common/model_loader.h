@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <memory_resource>
+
+// Buffers come from `mr`; the client's loader passes its pool (MeshBufferPool), everything else
+// uses the default heap.
+struct MeshData {
+    explicit MeshData(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : positions(mr), indices(mr) {}
+
+    // positions: x,y,z,x,y,z,...
+    std::pmr::vector<float> positions;
+    // indices for triangle list
+    std::pmr::vector<uint32_t> indices;
+};
+
+// Bounds and size of a mesh in its own coordinates. Computed by the server for the manifest and
+// by the client after parsing, so both sides agree on placement.
+struct MeshStats {
+    float aabb_min[3] = { 0.0f, 0.0f, 0.0f };
+    float aabb_max[3] = { 0.0f, 0.0f, 0.0f };
+    float sphere_center[3] = { 0.0f, 0.0f, 0.0f }; // AABB center
+    float sphere_radius = 0.0f;                   // farthest vertex from sphere_center
+    uint64_t triangle_count = 0;
+};
+
+MeshStats ComputeMeshStats(const MeshData& mesh);
+
+// Mesh file formats ModelLoader understands, picked by file extension (case-insensitive).
+enum class MeshFormat { Unknown, Obj, Glb, Ply, Stl };
+
+class ModelLoader {
+public:
+    ModelLoader() = default;
+    ~ModelLoader() = default;
+
+    // Synchronously load OBJ at `path` and fill MeshData (positions only).
+    // Returns true on success, false on failure (reads tinyobj warnings/errors to stderr).
+    // This function is thread-safe (no internal state).
+    bool LoadOBJToMeshData(const std::string& path, MeshData& out, float scale = 1.0f, int artificial_ms_delay = 0) const;
+
+    // Same as LoadOBJToMeshData but parses OBJ text already held in memory (e.g. a streamed download).
+    bool LoadOBJFromMemory(const std::string& obj_text, MeshData& out, float scale = 1.0f, int artificial_ms_delay = 0) const;
+
+    static MeshFormat FormatFromName(std::string_view name);
+
+    // Loads any supported format from disk. Binary formats (.glb, .ply, .stl) are memory-mapped and
+    // decoded in place; OBJ goes through tinyobj.
+    bool LoadMeshFile(const std::string& path, MeshData& out, float scale = 1.0f, int artificial_ms_delay = 0) const;
+
+    // Decodes a whole file already held in memory; `name` (file name or relative path) selects the format.
+    bool LoadMeshFromMemory(std::string_view data, std::string_view name, MeshData& out, float scale = 1.0f, int artificial_ms_delay = 0) const;
+};
\ No newline at end of file
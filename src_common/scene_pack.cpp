@@ -0,0 +1,273 @@
+#include "scene_pack.h"
+#include "sha256.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef P4_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static constexpr char kMagic[8] = { 'P', '4', 'P', 'A', 'C', 'K', '0', '1' };
+static constexpr uint32_t kVersion = 1;
+static constexpr size_t kHeaderSize = 64;
+static constexpr size_t kEntryFixedSize = 8 + 8 + 8 + 4 + 2 + 2 + 32;
+// Compressed blobs are kept only if they save at least this fraction.
+static constexpr double kMinCompressionSaving = 0.10;
+
+static uint64_t AlignUp(uint64_t v, uint64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+static void PutU16(std::string& s, uint16_t v) {
+    for (int i = 0; i < 2; ++i) s.push_back(static_cast<char>(v >> (8 * i)));
+}
+static void PutU32(std::string& s, uint32_t v) {
+    for (int i = 0; i < 4; ++i) s.push_back(static_cast<char>(v >> (8 * i)));
+}
+static void PutU64(std::string& s, uint64_t v) {
+    for (int i = 0; i < 8; ++i) s.push_back(static_cast<char>(v >> (8 * i)));
+}
+static uint64_t GetLE(const char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | static_cast<uint8_t>(p[i]);
+    return v;
+}
+
+static size_t EntrySize(const std::string& name) {
+    return static_cast<size_t>(AlignUp(kEntryFixedSize + name.size(), 8));
+}
+
+bool WriteScenePack(const std::vector<PackSource>& sources, const fs::path& out_path, bool compress, std::string& error) {
+#ifndef P4_HAVE_ZLIB
+    (void)compress;
+#endif
+    size_t index_size = 0;
+    for (const auto& s : sources) {
+        if (s.name.size() > UINT16_MAX) {
+            error = "entry name too long: " + s.name;
+            return false;
+        }
+        index_size += EntrySize(s.name);
+    }
+
+    std::error_code ec;
+    fs::create_directories(out_path.parent_path(), ec);
+    fs::path tmp_path = out_path;
+    tmp_path += ".tmp";
+    std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        error = "can't create " + tmp_path.string();
+        return false;
+    }
+
+    // Blobs first (the index needs their offsets); the header and index go into the zero-filled
+    // gap at the start afterwards.
+    std::vector<PackEntry> entries;
+    std::vector<Sha256::Digest> digests;
+    entries.reserve(sources.size());
+    digests.reserve(sources.size());
+    uint64_t pos = AlignUp(kHeaderSize + index_size, kPackAlignment);
+    static const char kZeros[kPackAlignment] = {};
+    ofs.seekp(static_cast<std::streamoff>(pos));
+
+#ifdef P4_HAVE_ZLIB
+    std::string compressed;
+#endif
+    for (const auto& s : sources) {
+        MappedFile file;
+        if (!file.Open(s.path.string())) {
+            error = "can't read " + s.path.string();
+            ofs.close();
+            fs::remove(tmp_path, ec);
+            return false;
+        }
+        std::string_view raw = file.View();
+        PackEntry e;
+        e.name = s.name;
+        e.raw_size = raw.size();
+        Sha256 hasher;
+        hasher.Update(raw.data(), raw.size());
+        digests.push_back(hasher.Final());
+        e.offset = pos;
+        std::string_view stored = raw;
+#ifdef P4_HAVE_ZLIB
+        if (compress && !raw.empty()) {
+            uLongf bound = compressBound(static_cast<uLong>(raw.size()));
+            compressed.resize(bound);
+            if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &bound, reinterpret_cast<const Bytef*>(raw.data()),
+                          static_cast<uLong>(raw.size()), Z_DEFAULT_COMPRESSION) == Z_OK &&
+                bound <= raw.size() * (1.0 - kMinCompressionSaving)) {
+                stored = std::string_view(compressed.data(), bound);
+                e.compression = PackCompression::Zlib;
+            }
+        }
+#endif
+        e.stored_size = stored.size();
+        ofs.write(stored.data(), static_cast<std::streamsize>(stored.size()));
+        pos += stored.size();
+        uint64_t padded = AlignUp(pos, kPackAlignment);
+        ofs.write(kZeros, static_cast<std::streamsize>(padded - pos));
+        pos = padded;
+        entries.push_back(std::move(e));
+    }
+
+    std::string head;
+    head.reserve(kHeaderSize + index_size);
+    head.append(kMagic, sizeof(kMagic));
+    PutU32(head, kVersion);
+    PutU32(head, static_cast<uint32_t>(entries.size()));
+    PutU64(head, index_size);
+    PutU64(head, pos);
+    head.resize(kHeaderSize, '\0');
+    for (size_t k = 0; k < entries.size(); ++k) {
+        const PackEntry& e = entries[k];
+        size_t start = head.size();
+        PutU64(head, e.offset);
+        PutU64(head, e.stored_size);
+        PutU64(head, e.raw_size);
+        PutU32(head, static_cast<uint32_t>(e.compression));
+        PutU16(head, static_cast<uint16_t>(e.name.size()));
+        PutU16(head, 0);
+        head.append(reinterpret_cast<const char*>(digests[k].data()), digests[k].size());
+        head.append(e.name);
+        head.resize(start + EntrySize(e.name), '\0');
+    }
+    ofs.seekp(0);
+    ofs.write(head.data(), static_cast<std::streamsize>(head.size()));
+    ofs.close();
+    if (!ofs) {
+        error = "write failed for " + tmp_path.string();
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    fs::rename(tmp_path, out_path, ec);
+    if (ec) {
+        error = "can't move pack into place: " + ec.message();
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+bool ScenePack::Open(const fs::path& path, std::string& error) {
+    if (!file_.Open(path.string())) {
+        error = "can't map " + path.string();
+        return false;
+    }
+    return Parse(file_.View(), error);
+}
+
+bool ScenePack::Parse(std::string_view data, std::string& error) {
+    entries_.clear();
+    data_ = data;
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        error = "not a scene pack";
+        return false;
+    }
+    const char* h = data.data();
+    uint32_t version = static_cast<uint32_t>(GetLE(h + 8, 4));
+    uint32_t count = static_cast<uint32_t>(GetLE(h + 12, 4));
+    uint64_t index_size = GetLE(h + 16, 8);
+    uint64_t file_size = GetLE(h + 24, 8);
+    if (version != kVersion) {
+        error = "unsupported pack version " + std::to_string(version);
+        return false;
+    }
+    if (file_size != data.size() || index_size > data.size() - kHeaderSize) {
+        error = "truncated pack";
+        return false;
+    }
+
+    const char* p = h + kHeaderSize;
+    const char* index_end = p + index_size;
+    entries_.reserve(std::min<uint64_t>(count, index_size / kEntryFixedSize));
+    for (uint32_t i = 0; i < count; ++i) {
+        if (static_cast<size_t>(index_end - p) < kEntryFixedSize) {
+            error = "truncated pack index";
+            return false;
+        }
+        PackEntry e;
+        e.offset = GetLE(p, 8);
+        e.stored_size = GetLE(p + 8, 8);
+        e.raw_size = GetLE(p + 16, 8);
+        uint32_t compression = static_cast<uint32_t>(GetLE(p + 24, 4));
+        size_t name_len = static_cast<size_t>(GetLE(p + 28, 2));
+        Sha256::Digest digest;
+        std::memcpy(digest.data(), p + 32, digest.size());
+        e.content_hash = Sha256::ToHex(digest);
+        if (static_cast<size_t>(index_end - p) < kEntryFixedSize + name_len) {
+            error = "truncated pack index";
+            return false;
+        }
+        e.name.assign(p + kEntryFixedSize, name_len);
+        if (compression > static_cast<uint32_t>(PackCompression::Zlib)) {
+            error = "unknown compression for " + e.name;
+            return false;
+        }
+        e.compression = static_cast<PackCompression>(compression);
+        if (e.offset > data.size() || e.stored_size > data.size() - e.offset) {
+            error = "blob out of range: " + e.name;
+            return false;
+        }
+        // deflate can't expand data by more than ~1032:1, so a larger raw size is corruption
+        // (and would make Read allocate an absurd buffer).
+        bool size_ok = e.compression == PackCompression::None ? e.stored_size == e.raw_size
+                                                              : e.raw_size / 1032 <= e.stored_size;
+        if (!size_ok) {
+            error = "size mismatch for " + e.name;
+            return false;
+        }
+        p += static_cast<size_t>(AlignUp(kEntryFixedSize + name_len, 8));
+        if (p > index_end) p = index_end;
+        entries_.push_back(std::move(e));
+    }
+    return true;
+}
+
+const PackEntry* ScenePack::Find(std::string_view name) const {
+    for (const auto& e : entries_) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+bool ScenePack::Read(const PackEntry& entry, std::string& storage, std::string_view& out, std::string& error) const {
+    std::string_view stored = data_.substr(static_cast<size_t>(entry.offset), static_cast<size_t>(entry.stored_size));
+    if (entry.compression == PackCompression::None) {
+        out = stored;
+        return true;
+    }
+#ifdef P4_HAVE_ZLIB
+    storage.resize(static_cast<size_t>(entry.raw_size));
+    uLongf raw_size = static_cast<uLongf>(entry.raw_size);
+    int rc = uncompress(reinterpret_cast<Bytef*>(storage.data()), &raw_size,
+                        reinterpret_cast<const Bytef*>(stored.data()), static_cast<uLong>(stored.size()));
+    if (rc != Z_OK || raw_size != entry.raw_size) {
+        error = "corrupt compressed blob: " + entry.name;
+        storage.clear();
+        return false;
+    }
+    out = storage;
+    return true;
+#else
+    (void)storage;
+    error = "pack blob " + entry.name + " is compressed but zlib support isn't built in";
+    return false;
+#endif
+}
+
+bool ScenePack::Verify(std::string& error) const {
+    std::string storage;
+    for (const auto& e : entries_) {
+        std::string_view raw;
+        if (!Read(e, storage, raw, error)) return false;
+        if (Sha256::HexDigest(raw) != e.content_hash) {
+            error = "hash mismatch for " + e.name;
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
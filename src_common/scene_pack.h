@@ -0,0 +1,71 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// .p4pack: every model of a scene in one file, so a scene is one sequential read (or one mmap)
+// instead of an open + read per model. Little-endian layout:
+//
+//   header (64 bytes)   magic "P4PACK01", u32 version, u32 entry count, u64 index size,
+//                       u64 file size, 32 reserved bytes
+//   index               per entry: u64 offset, u64 stored size, u64 raw size, u32 compression,
+//                       u16 name length, u16 reserved, 32-byte SHA-256 of the raw bytes,
+//                       name bytes, zero padding to a multiple of 8
+//   blobs               each starting on a kPackAlignment boundary
+//
+// Blobs are stored raw unless zlib (P4_HAVE_ZLIB) shrinks them noticeably; raw blobs can be
+// parsed straight out of the mapping.
+
+enum class PackCompression : uint32_t { None = 0, Zlib = 1 };
+
+struct PackEntry {
+    std::string name;
+    uint64_t offset = 0;
+    uint64_t stored_size = 0;
+    uint64_t raw_size = 0;
+    PackCompression compression = PackCompression::None;
+    std::string content_hash; // hex SHA-256 of the raw bytes
+};
+
+struct PackSource {
+    std::string name;           // entry name (the model's rel_path)
+    std::filesystem::path path; // file to read
+};
+
+constexpr size_t kPackAlignment = 4096;
+
+// Writes a pack of `sources` to out_path (through a temporary file, so readers never see a
+// partial pack). compress is ignored without zlib.
+bool WriteScenePack(const std::vector<PackSource>& sources, const std::filesystem::path& out_path, bool compress, std::string& error);
+
+// Read-only view of a pack, either memory-mapped from disk (Open) or over caller-owned bytes
+// (Parse). Move-only; views returned by Read stay valid while the pack is open.
+class ScenePack {
+public:
+    ScenePack() = default;
+    ScenePack(ScenePack&&) noexcept = default;
+    ScenePack& operator=(ScenePack&&) noexcept = default;
+    ScenePack(const ScenePack&) = delete;
+    ScenePack& operator=(const ScenePack&) = delete;
+
+    bool Open(const std::filesystem::path& path, std::string& error);
+    bool Parse(std::string_view data, std::string& error);
+
+    const std::vector<PackEntry>& Entries() const { return entries_; }
+    const PackEntry* Find(std::string_view name) const;
+
+    // An entry's raw bytes: a view into the pack for stored blobs, or decompressed into `storage`.
+    bool Read(const PackEntry& entry, std::string& storage, std::string_view& out, std::string& error) const;
+
+    // Check every entry against its hash (after a download, before the pack is trusted).
+    bool Verify(std::string& error) const;
+
+private:
+    MappedFile file_;
+    std::string_view data_;
+    std::vector<PackEntry> entries_;
+};
\ No newline at end of file
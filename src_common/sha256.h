@@ -0,0 +1,32 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// SHA-256 (FIPS 180-4), used to address model files by content. Incremental: Update any number
+// of times, then Final once.
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256();
+    void Update(const void* data, size_t size);
+    Digest Final();
+
+    // One-shot helpers returning 64 lowercase hex digits.
+    static std::string HexDigest(std::string_view data);
+    static std::string ToHex(const Digest& digest);
+    // True for 64 lowercase hex digits (a string ToHex could have produced).
+    static bool IsHexDigest(std::string_view s);
+
+private:
+    void Block(const uint8_t* p);
+
+    uint32_t state_[8];
+    uint8_t buffer_[64];
+    size_t buffered_ = 0;
+    uint64_t length_ = 0; // bytes hashed so far
+};
\ No newline at end of file
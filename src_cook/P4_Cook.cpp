@@ -0,0 +1,33 @@
+#include "cooker.h"
+#include <iostream>
+#include <string>
+#include <cstring>
+
+// Offline asset cooker; run it after adding or changing media, the server picks the output up.
+// Usage: P4_Cook [media_root] [threads] [--force]
+int main(int argc, char** argv) {
+    std::string media_root = "Media";
+    CookOptions options;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--force") == 0) {
+            options.force = true;
+        } else if (positional == 0) {
+            media_root = argv[i];
+            ++positional;
+        } else if (positional == 1) {
+            options.thread_count = static_cast<size_t>(std::stoull(argv[i]));
+            ++positional;
+        } else {
+            std::cerr << "Usage: P4_Cook [media_root] [threads] [--force]\n";
+            return 2;
+        }
+    }
+
+    Cooker cooker(media_root, options);
+    CookStats stats;
+    bool ok = cooker.Run(stats);
+    std::cout << "Cooked " << stats.cooked << " models (" << stats.up_to_date << " up to date, "
+              << stats.failed << " failed), " << stats.thumbnails << " thumbnails written\n";
+    return ok ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "cooker.h"
+#include "cooked_mesh.h"
+#include "mapped_file.h"
+#include "mesh_lod.h"
+#include "model_loader.h"
+#include "sha256.h"
+#include "thumbnail.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// The names the server looks for, in the same order.
+static const char* const kThumbnailNames[] = { "thumbnail.png", "thumbnail.jpg", "thumb.png", "thumb.jpg" };
+
+Cooker::Cooker(std::string media_root, CookOptions options)
+    : media_root_(std::move(media_root)), out_root_(media_root_ / ".cooked"), options_(options) {}
+
+bool Cooker::Run(CookStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    if (!options_.force) LoadStamps();
+    std::vector<Job> jobs = ListModels();
+
+    std::vector<std::string> scenes;
+    for (const auto& j : jobs) {
+        if (scenes.empty() || scenes.back() != j.scene_id) scenes.push_back(j.scene_id);
+    }
+
+    // Models first (the expensive part), then thumbnails, from one shared work list.
+    std::atomic<size_t> next{ 0 };
+    std::atomic<bool> ok{ true };
+    size_t total = jobs.size() + scenes.size();
+    auto work = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < total;) {
+            if (i < jobs.size()) {
+                if (!CookModel(jobs[i], stats)) ok.store(false);
+            } else {
+                bool written = false;
+                if (!CookThumbnail(scenes[i - jobs.size()], written)) ok.store(false);
+                std::scoped_lock lk(mtx_);
+                if (written) ++stats.thumbnails;
+            }
+        }
+    };
+    size_t thread_count = options_.thread_count ? options_.thread_count : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::max<size_t>(1, std::min(thread_count, total));
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < thread_count; ++t) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+
+    if (!SaveStamps()) ok.store(false);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[Cooker] " << jobs.size() << " models in " << scenes.size() << " scenes on " << thread_count
+              << " threads, " << ms << " ms\n";
+    return ok.load();
+}
+
+std::vector<Cooker::Job> Cooker::ListModels() const {
+    std::vector<Job> jobs;
+    std::error_code ec;
+    for (const auto& scene : fs::directory_iterator(media_root_, ec)) {
+        std::string scene_id = scene.path().filename().string();
+        if (!scene.is_directory(ec) || scene_id.empty() || scene_id[0] == '.') continue;
+        for (const auto& de : fs::directory_iterator(scene.path(), ec)) {
+            if (!de.is_regular_file(ec)) continue;
+            if (ModelLoader::FormatFromName(de.path().filename().string()) == MeshFormat::Unknown) continue;
+            jobs.push_back({ scene_id, de.path() });
+        }
+    }
+    if (ec) std::cerr << "[Cooker] Error listing " << media_root_ << ": " << ec.message() << "\n";
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.source < b.source; });
+    return jobs;
+}
+
+bool Cooker::CookModel(const Job& job, CookStats& stats) {
+    std::string key = fs::relative(job.source, media_root_).generic_string();
+    std::error_code ec;
+    Stamp stamp;
+    stamp.size = fs::file_size(job.source, ec);
+    if (!ec) stamp.mtime = static_cast<int64_t>(fs::last_write_time(job.source, ec).time_since_epoch().count());
+    if (ec) {
+        std::cerr << "[Cooker] Can't stat " << key << ": " << ec.message() << "\n";
+        std::scoped_lock lk(mtx_);
+        ++stats.failed;
+        return false;
+    }
+
+    // Unchanged since the last run: trust the recorded hash instead of reading the file.
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = stamps_.find(key);
+        if (it != stamps_.end() && it->second.size == stamp.size && it->second.mtime == stamp.mtime) {
+            stamp.hash = it->second.hash;
+        }
+    }
+    MappedFile file;
+    if (stamp.hash.empty()) {
+        if (!file.Open(job.source.string())) {
+            std::scoped_lock lk(mtx_);
+            ++stats.failed;
+            return false;
+        }
+        stamp.hash = Sha256::HexDigest(file.View());
+    }
+
+    fs::path out_path = CookedMeshPath(media_root_, stamp.hash);
+    bool claimed = false;
+    {
+        std::scoped_lock lk(mtx_);
+        stamps_[key] = stamp;
+        // Another job has (or is) cooking the same content.
+        claimed = claimed_.insert(stamp.hash).second;
+    }
+    if (!claimed || (!options_.force && IsCurrent(out_path, stamp.hash))) {
+        std::scoped_lock lk(mtx_);
+        ++stats.up_to_date;
+        return true;
+    }
+
+    auto fail = [&](const std::string& what) {
+        std::cerr << "[Cooker] " << key << ": " << what << "\n";
+        std::scoped_lock lk(mtx_);
+        stamps_.erase(key); // re-hash next time
+        ++stats.failed;
+        return false;
+    };
+
+    ModelLoader loader;
+    MeshData mesh;
+    bool loaded = file.IsOpen() ? loader.LoadMeshFromMemory(file.View(), job.source.filename().string(), mesh)
+                                : loader.LoadMeshFile(job.source.string(), mesh);
+    if (!loaded) return fail("decode failed");
+    file.Close();
+
+    MeshStats mesh_stats = ComputeMeshStats(mesh);
+    std::vector<MeshData> lods = BuildLods(mesh, mesh_stats, options_.max_lods);
+    std::string encoded, error;
+    if (!EncodeCookedMesh(lods, mesh_stats, stamp.hash, encoded, error)) return fail(error);
+
+    fs::create_directories(out_path.parent_path(), ec);
+    fs::path tmp_path = out_path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        ofs.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+        if (!ofs) return fail("can't write " + tmp_path.string());
+    }
+    fs::rename(tmp_path, out_path, ec);
+    if (ec) {
+        fs::remove(tmp_path, ec);
+        return fail("can't rename to " + out_path.string());
+    }
+
+    std::ostringstream lod_sizes;
+    for (const auto& l : lods) lod_sizes << " " << l.indices.size() / 3;
+    std::cerr << "[Cooker] " << key << " -> " << out_path.filename().string().substr(0, 12) << "... tris" << lod_sizes.str() << "\n";
+    std::scoped_lock lk(mtx_);
+    ++stats.cooked;
+    return true;
+}
+
+bool Cooker::CookThumbnail(const std::string& scene_id, bool& written) {
+    fs::path scene_dir = media_root_ / scene_id;
+    std::error_code ec;
+    for (const char* name : kThumbnailNames) {
+        fs::path source = scene_dir / name;
+        if (!fs::is_regular_file(source, ec)) continue;
+        fs::path out_path = CookedThumbnailPath(media_root_, scene_id);
+        if (!options_.force && fs::exists(out_path, ec) && fs::last_write_time(out_path, ec) >= fs::last_write_time(source, ec) && !ec) {
+            return true;
+        }
+        std::string error;
+        if (!::CookThumbnail(source, out_path, options_.thumbnail_size, error)) {
+            std::cerr << "[Cooker] Thumbnail of " << scene_id << ": " << error << "\n";
+            return false;
+        }
+        written = true;
+        return true;
+    }
+    return true;
+}
+
+bool Cooker::IsCurrent(const fs::path& path, const std::string& source_hash) {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) return false;
+    MappedFile file;
+    if (!file.Open(path.string())) return false;
+    CookedMeshInfo info;
+    std::string error;
+    return ReadCookedMeshInfo(file.View(), info, error) && info.source_hash == source_hash;
+}
+
+// stamps.tsv: one "<size>\t<mtime>\t<hash>\t<relative path>" line per source.
+void Cooker::LoadStamps() {
+    std::ifstream ifs(out_root_ / "stamps.tsv");
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream ls(line);
+        Stamp s;
+        std::string path;
+        if (!(ls >> s.size >> s.mtime >> s.hash) || !Sha256::IsHexDigest(s.hash)) continue;
+        ls.ignore(1);
+        if (!std::getline(ls, path) || path.empty()) continue;
+        stamps_[path] = std::move(s);
+    }
+}
+
+bool Cooker::SaveStamps() const {
+    std::error_code ec;
+    fs::create_directories(out_root_, ec);
+    fs::path path = out_root_ / "stamps.tsv";
+    fs::path tmp_path = path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::trunc);
+        for (const auto& [key, s] : stamps_) ofs << s.size << '\t' << s.mtime << '\t' << s.hash << '\t' << key << '\n';
+        if (!ofs) {
+            std::cerr << "[Cooker] Can't write " << tmp_path << "\n";
+            return false;
+        }
+    }
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        std::cerr << "[Cooker] Can't replace " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct CookOptions {
+    size_t thread_count = 0;     // 0 = hardware concurrency
+    bool force = false;          // re-cook everything, ignoring stamps and existing output
+    size_t max_lods = 4;         // including LOD 0
+    int thumbnail_size = 256;    // longest side of cooked thumbnails, in pixels
+};
+
+struct CookStats {
+    size_t cooked = 0;
+    size_t up_to_date = 0;
+    size_t failed = 0;
+    size_t thumbnails = 0; // written this run
+};
+
+// Offline preprocessing of everything under media_root (see cooked_mesh.h for the output layout).
+// Models of every scene are cooked in parallel into .p4mesh files: decoded once, with bounds,
+// LODs and the source hash baked in, so neither the server nor clients parse them again. Scene
+// thumbnails are downscaled to PNG.
+//
+// Rebuilds are incremental: <media_root>/.cooked/stamps.tsv remembers each source's size, write
+// time and hash, so unchanged files are not even re-hashed, and output for a hash that's already
+// cooked (the same prop in another scene, or a touched but unchanged file) is reused.
+class Cooker {
+public:
+    Cooker(std::string media_root, CookOptions options);
+
+    // Cooks everything that's out of date. False if any model or thumbnail failed.
+    bool Run(CookStats& stats);
+
+private:
+    struct Stamp {
+        uintmax_t size = 0;
+        int64_t mtime = 0;
+        std::string hash;
+    };
+    struct Job {
+        std::string scene_id;
+        std::filesystem::path source;
+    };
+
+    std::vector<Job> ListModels() const;
+    bool CookModel(const Job& job, CookStats& stats);
+    // Scenes without a thumbnail succeed with written=false, as do up-to-date ones.
+    bool CookThumbnail(const std::string& scene_id, bool& written);
+    // True if `path` is a .p4mesh of the current version cooked from `source_hash`.
+    static bool IsCurrent(const std::filesystem::path& path, const std::string& source_hash);
+
+    void LoadStamps();
+    bool SaveStamps() const;
+
+    std::filesystem::path media_root_;
+    std::filesystem::path out_root_;
+    CookOptions options_;
+
+    std::mutex mtx_; // guards everything below and the stats passed to Run
+    std::unordered_map<std::string, Stamp> stamps_; // by source path relative to media_root
+    std::unordered_set<std::string> claimed_;       // hashes being cooked or done this run
+};
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "mesh_lod.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+// Grid resolutions tried for LOD 1, 2, ... (cells along the longest axis).
+static constexpr uint32_t kLodGrids[] = { 96, 48, 24, 12 };
+static constexpr uint64_t kMinLodTriangles = 32;
+
+MeshData SimplifyByClustering(const MeshData& mesh, const MeshStats& stats, uint32_t grid_resolution) {
+    MeshData out;
+    size_t vertex_count = mesh.positions.size() / 3;
+    float extent[3];
+    float max_extent = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        extent[k] = stats.aabb_max[k] - stats.aabb_min[k];
+        max_extent = std::max(max_extent, extent[k]);
+    }
+    if (vertex_count == 0 || max_extent <= 0.0f || grid_resolution == 0) return out;
+    // At most 128^3 = 2^21 clusters, so a triangle's three cluster ids pack into one key below.
+    grid_resolution = std::min(grid_resolution, 128u);
+
+    // Cubic cells, so the coarsening is the same along every axis.
+    float cell = max_extent / static_cast<float>(grid_resolution);
+    uint32_t cells[3];
+    for (int k = 0; k < 3; ++k) cells[k] = std::clamp(static_cast<uint32_t>(std::ceil(extent[k] / cell)), 1u, grid_resolution);
+    auto cell_of = [&](const float* p) {
+        uint64_t key = 0;
+        for (int k = 0; k < 3; ++k) {
+            uint32_t c = static_cast<uint32_t>(std::max(0.0f, (p[k] - stats.aabb_min[k]) / cell));
+            key = key * (uint64_t(cells[k]) + 1) + std::min(c, cells[k] - 1);
+        }
+        return key;
+    };
+
+    // Cluster id per source vertex, and the running sum of each cluster's members.
+    std::unordered_map<uint64_t, uint32_t> cluster_of_cell;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<double> sums;
+    std::vector<uint32_t> counts;
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const float* p = &mesh.positions[3 * v];
+        auto [it, inserted] = cluster_of_cell.try_emplace(cell_of(p), static_cast<uint32_t>(counts.size()));
+        if (inserted) {
+            sums.insert(sums.end(), { 0.0, 0.0, 0.0 });
+            counts.push_back(0);
+        }
+        uint32_t c = it->second;
+        remap[v] = c;
+        for (int k = 0; k < 3; ++k) sums[3 * c + k] += p[k];
+        ++counts[c];
+    }
+
+    out.positions.resize(counts.size() * 3);
+    for (size_t c = 0; c < counts.size(); ++c) {
+        for (int k = 0; k < 3; ++k) out.positions[3 * c + k] = static_cast<float>(sums[3 * c + k] / counts[c]);
+    }
+
+    // Keep triangles whose corners landed in three different cells, once each (either winding
+    // of the same three clusters is a separate triangle, so back faces survive).
+    std::unordered_set<uint64_t> seen;
+    out.indices.reserve(mesh.indices.size() / 2);
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        uint32_t a = mesh.indices[t], b = mesh.indices[t + 1], c = mesh.indices[t + 2];
+        if (a >= vertex_count || b >= vertex_count || c >= vertex_count) continue;
+        a = remap[a]; b = remap[b]; c = remap[c];
+        if (a == b || b == c || a == c) continue;
+        // Rotate so the smallest id comes first; keeps the winding.
+        if (b < a && b < c) { std::swap(a, b); std::swap(b, c); }
+        else if (c < a && c < b) { std::swap(a, c); std::swap(b, c); }
+        uint64_t key = uint64_t(a) | (uint64_t(b) << 21) | (uint64_t(c) << 42);
+        if (!seen.insert(key).second) continue;
+        out.indices.insert(out.indices.end(), { a, b, c });
+    }
+
+    // Drop clusters no surviving triangle uses.
+    std::vector<uint32_t> used(counts.size(), UINT32_MAX);
+    MeshData compact;
+    for (uint32_t& i : out.indices) {
+        if (used[i] == UINT32_MAX) {
+            used[i] = static_cast<uint32_t>(compact.positions.size() / 3);
+            compact.positions.insert(compact.positions.end(), &out.positions[3 * i], &out.positions[3 * i] + 3);
+        }
+        i = used[i];
+    }
+    compact.indices = std::move(out.indices);
+    return compact;
+}
+
+std::vector<MeshData> BuildLods(const MeshData& mesh, const MeshStats& stats, size_t max_lods) {
+    std::vector<MeshData> lods;
+    lods.emplace_back();
+    lods.back().positions = mesh.positions;
+    lods.back().indices = mesh.indices;
+
+    uint64_t triangles = mesh.indices.size() / 3;
+    for (uint32_t grid : kLodGrids) {
+        if (lods.size() >= max_lods || triangles < kMinLodTriangles * 2) break;
+        MeshData lod = SimplifyByClustering(lods.front(), stats, grid);
+        uint64_t lod_triangles = lod.indices.size() / 3;
+        // Not coarse enough to pay for its memory; try the next, coarser grid.
+        if (lod_triangles * 4 > triangles * 3) continue;
+        if (lod_triangles < kMinLodTriangles) break;
+        triangles = lod_triangles;
+        lods.push_back(std::move(lod));
+    }
+    return lods;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "model_loader.h"
+#include <vector>
+
+// Coarser versions of a mesh by vertex clustering: vertices are snapped to a uniform grid over
+// the mesh bounds, each occupied cell becomes one vertex (the average of its members), and
+// triangles that collapse are dropped. Fast and robust for any triangle soup (including unwelded
+// STL); quality is below error-driven simplification, which is acceptable for distant LODs.
+MeshData SimplifyByClustering(const MeshData& mesh, const MeshStats& stats, uint32_t grid_resolution);
+
+// LOD 0 (a copy of `mesh`) followed by successively coarser clusterings. Stops early once a level
+// no longer removes at least a quarter of the triangles or gets too small to be worth drawing.
+std::vector<MeshData> BuildLods(const MeshData& mesh, const MeshStats& stats, size_t max_lods);
\ No newline at end of file
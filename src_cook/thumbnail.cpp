@@ -0,0 +1,51 @@
+#include "thumbnail.h"
+#include <algorithm>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include <stb_image_resize2.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace fs = std::filesystem;
+
+bool CookThumbnail(const fs::path& source, const fs::path& out_path, int max_size, std::string& error) {
+    int w = 0, h = 0, channels = 0;
+    stbi_uc* pixels = stbi_load(source.string().c_str(), &w, &h, &channels, 4);
+    if (!pixels) {
+        error = std::string("can't decode: ") + stbi_failure_reason();
+        return false;
+    }
+
+    int longest = std::max(w, h);
+    int out_w = w, out_h = h;
+    if (max_size > 0 && longest > max_size) {
+        out_w = std::max(1, static_cast<int>(static_cast<int64_t>(w) * max_size / longest));
+        out_h = std::max(1, static_cast<int>(static_cast<int64_t>(h) * max_size / longest));
+    }
+    std::vector<unsigned char> resized(static_cast<size_t>(out_w) * out_h * 4);
+    bool ok = stbir_resize_uint8_srgb(pixels, w, h, 0, resized.data(), out_w, out_h, 0, STBIR_RGBA) != nullptr;
+    stbi_image_free(pixels);
+    if (!ok) {
+        error = "resize failed";
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(out_path.parent_path(), ec);
+    fs::path tmp_path = out_path;
+    tmp_path += ".tmp";
+    if (!stbi_write_png(tmp_path.string().c_str(), out_w, out_h, 4, resized.data(), out_w * 4)) {
+        error = "can't write " + tmp_path.string();
+        return false;
+    }
+    fs::rename(tmp_path, out_path, ec);
+    if (ec) {
+        error = "can't rename to " + out_path.string() + ": " + ec.message();
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+// Decodes an image (PNG/JPEG/...), shrinks it so its longest side is at most max_size (smaller
+// images keep their size) and writes it as PNG. On failure returns false and sets `error`.
+bool CookThumbnail(const std::filesystem::path& source, const std::filesystem::path& out_path, int max_size, std::string& error);
\ No newline at end of file
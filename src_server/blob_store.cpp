@@ -0,0 +1,117 @@
+#include "blob_store.h"
+#include "mapped_file.h"
+#include "sha256.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+BlobStore::BlobStore(const std::string& media_root) : root_(fs::path(media_root) / ".blobs") {}
+
+std::string BlobStore::HashFile(const fs::path& path) {
+    MappedFile file;
+    if (!file.Open(path.string())) return std::string();
+    return Sha256::HexDigest(file.View());
+}
+
+bool BlobStore::Unchanged(const BlobEntry& blob) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(blob.path, ec);
+    if (ec || size != blob.size) return false;
+    fs::file_time_type mtime = fs::last_write_time(blob.path, ec);
+    return !ec && mtime == blob.mtime;
+}
+
+std::string BlobStore::Ingest(const fs::path& path) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec) return std::string();
+    fs::file_time_type mtime = fs::last_write_time(path, ec);
+    if (ec) return std::string();
+
+    const std::string key = path.string();
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = files_.find(key);
+        if (it != files_.end() && it->second.size == size && it->second.mtime == mtime) {
+            auto blob = blobs_.find(it->second.hash);
+            if (blob != blobs_.end() && Unchanged(blob->second)) return it->second.hash;
+        }
+    }
+
+    // Hash outside the lock; concurrent manifest threads hash different files in parallel.
+    std::string hash = HashFile(path);
+    if (hash.empty()) return hash;
+
+    std::scoped_lock lk(mtx_);
+    auto blob = blobs_.find(hash);
+    if (blob == blobs_.end() || !Unchanged(blob->second)) {
+        blobs_[hash] = StoreLocked(hash, path);
+    }
+    files_[key] = FileEntry{ size, mtime, hash };
+    return hash;
+}
+
+BlobStore::BlobEntry BlobStore::StoreLocked(const std::string& hash, const fs::path& source) {
+    std::string ext = source.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    fs::path target = root_ / hash.substr(0, 2) / (hash + ext);
+
+    std::error_code ec;
+    // A blob left by an earlier run may have been edited in place through a hard link meanwhile.
+    if (fs::exists(target, ec) && !fs::equivalent(source, target, ec) && HashFile(target) != hash) fs::remove(target, ec);
+    if (!fs::exists(target, ec)) {
+        fs::create_directories(target.parent_path(), ec);
+        fs::create_hard_link(source, target, ec);
+        if (ec) {
+            // Different volume or no link support: copy, then rename so readers never see a partial blob.
+            fs::path tmp = target;
+            tmp += ".tmp";
+            ec.clear();
+            fs::copy_file(source, tmp, fs::copy_options::overwrite_existing, ec);
+            if (!ec) fs::rename(tmp, target, ec);
+            if (ec) {
+                fs::remove(tmp, ec);
+                std::cerr << "[BlobStore] Can't store blob for " << source << ", serving it in place\n";
+                target = source;
+            }
+        }
+    }
+
+    BlobEntry entry;
+    entry.path = target;
+    entry.size = fs::file_size(target, ec);
+    entry.mtime = fs::last_write_time(target, ec);
+    return entry;
+}
+
+fs::path BlobStore::PathFor(const std::string& hash) {
+    std::scoped_lock lk(mtx_);
+    auto it = blobs_.find(hash);
+    if (it == blobs_.end()) return fs::path();
+    if (!Unchanged(it->second)) {
+        // Edited in place (through a hard link, or the fallback source): the content no longer
+        // matches its name. The next manifest re-ingests the file.
+        blobs_.erase(it);
+        return fs::path();
+    }
+    return it->second.path;
+}
+
+fs::path BlobStore::BlobFor(const fs::path& path) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec) return fs::path();
+    fs::file_time_type mtime = fs::last_write_time(path, ec);
+    if (ec) return fs::path();
+
+    std::string hash;
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = files_.find(path.string());
+        if (it == files_.end() || it->second.size != size || it->second.mtime != mtime) return fs::path();
+        hash = it->second.hash;
+    }
+    return PathFor(hash);
+}
\ No newline at end of file
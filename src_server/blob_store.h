@@ -0,0 +1,51 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Content-addressed view of the model files under media_root. Every model is hashed (SHA-256)
+// and linked into <media_root>/.blobs/<first two hex digits>/<hash><ext>, so a prop copied into
+// ten scene folders is one blob: manifests name it by hash, the read and stats caches key on the
+// blob path, and clients download and cache it once. Links are hard links where the filesystem
+// allows, otherwise copies; if .blobs can't be written the first file with the content serves as
+// the blob. Hashes are cached by path, size and write time. Thread-safe.
+class BlobStore {
+public:
+    explicit BlobStore(const std::string& media_root);
+
+    // Hash of a model file (hex SHA-256), adding its content to the store if new. Empty if the
+    // file can't be read.
+    std::string Ingest(const std::filesystem::path& path);
+
+    // Blob with this hash, or empty if unknown or modified since it was stored.
+    std::filesystem::path PathFor(const std::string& hash);
+
+    // Blob holding the current content of an already ingested file; empty if the file wasn't
+    // ingested or changed since.
+    std::filesystem::path BlobFor(const std::filesystem::path& path);
+
+private:
+    struct FileEntry {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+        std::string hash;
+    };
+    struct BlobEntry {
+        std::filesystem::path path;
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+    };
+
+    static std::string HashFile(const std::filesystem::path& path);
+    // Create (or verify a leftover from an earlier run of) the blob for `source`. Needs mtx_.
+    BlobEntry StoreLocked(const std::string& hash, const std::filesystem::path& source);
+    // The blob still has the size and write time it was stored with.
+    static bool Unchanged(const BlobEntry& blob);
+
+    std::filesystem::path root_;
+    std::mutex mtx_;
+    std::unordered_map<std::string, FileEntry> files_; // by source path
+    std::unordered_map<std::string, BlobEntry> blobs_; // by hash
+};
\ No newline at end of file
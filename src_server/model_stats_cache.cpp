@@ -0,0 +1,40 @@
+#include "model_stats_cache.h"
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+bool ModelStatsCache::Get(const fs::path& path, MeshStats& out) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec) return false;
+    fs::file_time_type mtime = fs::last_write_time(path, ec);
+    if (ec) return false;
+
+    const std::string key = path.string();
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.size == size && it->second.mtime == mtime) {
+            out = it->second.stats;
+            return it->second.ok;
+        }
+    }
+
+    // Parse outside the lock. Two requests missing on the same file may both parse it; harmless.
+    Entry entry;
+    entry.size = size;
+    entry.mtime = mtime;
+    ModelLoader loader;
+    MeshData mesh;
+    entry.ok = loader.LoadMeshFile(key, mesh);
+    if (entry.ok) {
+        entry.stats = ComputeMeshStats(mesh);
+    } else {
+        std::cerr << "[ModelStatsCache] No bounds for " << key << "\n";
+    }
+
+    out = entry.stats;
+    std::scoped_lock lk(mtx_);
+    entries_[key] = entry;
+    return entry.ok;
+}
\ No newline at end of file
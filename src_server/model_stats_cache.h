@@ -0,0 +1,28 @@
+#pragma once
+
+#include "model_loader.h"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Per-file mesh statistics (bounds, triangle count) for the manifest. Parsing a model is far more
+// expensive than listing it, so results are kept until the file's size or write time changes.
+// Thread-safe; concurrent misses for different files parse in parallel.
+class ModelStatsCache {
+public:
+    // Returns false if the file can't be parsed (also cached, so broken files aren't re-parsed
+    // on every manifest request).
+    bool Get(const std::filesystem::path& path, MeshStats& out);
+
+private:
+    struct Entry {
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+        bool ok = false;
+        MeshStats stats;
+    };
+
+    std::mutex mtx_;
+    std::unordered_map<std::string, Entry> entries_;
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "read_coalescer.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// Disk reads are published in blocks of this size so streams can start before the read ends.
+static constexpr size_t kReadBlock = 1 << 20;
+
+size_t ReadCoalescer::SharedRead::WaitForData(size_t offset, const std::function<bool()>& stop) {
+    std::unique_lock lk(mtx_);
+    auto ready = [&]() { return published_ > offset || done_; };
+    if (!stop) {
+        cv_.wait(lk, ready);
+    } else {
+        while (!cv_.wait_for(lk, std::chrono::milliseconds(10), ready)) {
+            if (stop()) return 0;
+        }
+    }
+    return published_ > offset ? published_ - offset : 0;
+}
+
+bool ReadCoalescer::SharedRead::Failed() const {
+    std::scoped_lock lk(mtx_);
+    return failed_;
+}
+
+void ReadCoalescer::SharedRead::Publish(size_t total_bytes) {
+    {
+        std::scoped_lock lk(mtx_);
+        published_ = total_bytes;
+    }
+    cv_.notify_all();
+}
+
+void ReadCoalescer::SharedRead::Finish(bool ok) {
+    {
+        std::scoped_lock lk(mtx_);
+        done_ = true;
+        failed_ = !ok;
+    }
+    cv_.notify_all();
+}
+
+ReadCoalescer::~ReadCoalescer() {
+    std::unique_lock lk(mtx_);
+    idle_cv_.wait(lk, [&]() { return readers_running_ == 0; });
+}
+
+std::shared_ptr<ReadCoalescer::SharedRead> ReadCoalescer::Open(const fs::path& path) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    if (ec || size > max_shared_bytes_) return nullptr;
+
+    std::string key = fs::absolute(path, ec).lexically_normal().string();
+    if (ec) key = path.string();
+
+    std::shared_ptr<SharedRead> read;
+    {
+        std::scoped_lock lk(mtx_);
+        auto it = in_flight_.find(key);
+        if (it != in_flight_.end()) {
+            it->second->consumers_.fetch_add(1);
+            return it->second;
+        }
+        read = std::make_shared<SharedRead>(static_cast<size_t>(size));
+        read->consumers_.store(1);
+        in_flight_.emplace(key, read);
+        ++readers_running_;
+    }
+    // The reader runs on its own thread so it isn't paced by (or cancelled with) any one stream.
+    std::thread(&ReadCoalescer::ReadFile, this, std::move(key), path, read).detach();
+    return read;
+}
+
+void ReadCoalescer::ReadFile(std::string key, fs::path path, std::shared_ptr<SharedRead> read) {
+    bool ok = false;
+    bool abandoned = false;
+    std::ifstream ifs(path, std::ios::binary);
+    if (ifs) {
+        size_t total = 0;
+        while (total < read->size_) {
+            // Nobody is streaming this file any more: stop reading. Checked again under the lock
+            // so an Open racing with this either joins before the entry is dropped or starts fresh.
+            if (read->consumers_.load() == 0) {
+                std::scoped_lock lk(mtx_);
+                if (read->consumers_.load() == 0) {
+                    auto it = in_flight_.find(key);
+                    if (it != in_flight_.end() && it->second == read) in_flight_.erase(it);
+                    abandoned = true;
+                    break;
+                }
+            }
+            size_t want = std::min(kReadBlock, read->size_ - total);
+            ifs.read(read->data_.get() + total, static_cast<std::streamsize>(want));
+            size_t got = static_cast<size_t>(ifs.gcount());
+            if (got == 0) break;
+            total += got;
+            read->Publish(total);
+        }
+        // A file that shrank while being read is served up to where it ended.
+        ok = !ifs.bad() && !abandoned;
+    }
+    if (!ok && !abandoned) std::cerr << "[ReadCoalescer] Failed to read " << path.string() << "\n";
+
+    read->Finish(ok);
+
+    // New requests from here on start a fresh read (the file may have changed).
+    std::scoped_lock lk(mtx_);
+    auto it = in_flight_.find(key);
+    if (it != in_flight_.end() && it->second == read) in_flight_.erase(it);
+    --readers_running_;
+    idle_cv_.notify_all();
+}
\ No newline at end of file
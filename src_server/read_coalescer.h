@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Single-flight file reads. Concurrent StreamModel calls for the same file share one read: the
+// first request starts a background reader that fills a buffer sized to the file, and every
+// stream (including the first) sends from that buffer, following the reader as it advances.
+// Late joiners send the prefix that's already in memory and then wait for the rest.
+// An entry is dropped once its read completes; streams still sending keep the buffer alive.
+// If every stream of a read goes away (cancelled / deadline), the disk read stops at the next block.
+class ReadCoalescer {
+public:
+    class SharedRead {
+    public:
+        explicit SharedRead(size_t size) : size_(size), data_(new char[size == 0 ? 1 : size]) {}
+
+        // Blocks until data beyond `offset` is available, the read has ended, or `stop` (polled
+        // every few ms) returns true. Returns the number of bytes readable at `offset`; 0 means end
+        // of data (see Failed()) or stopped.
+        size_t WaitForData(size_t offset, const std::function<bool()>& stop = nullptr);
+        const char* Data() const { return data_.get(); }
+        size_t Size() const { return size_; } // file size when the read started
+        bool Failed() const;
+
+        // Each stream returned by Open must call this once when it stops sending.
+        void Release() { consumers_.fetch_sub(1); }
+
+    private:
+        friend class ReadCoalescer;
+        void Publish(size_t total_bytes);
+        void Finish(bool ok);
+
+        const size_t size_;
+        std::unique_ptr<char[]> data_; // bytes [0, published_) are immutable once published
+        mutable std::mutex mtx_;
+        std::condition_variable cv_;
+        size_t published_ = 0;
+        bool done_ = false;
+        bool failed_ = false;
+        std::atomic<size_t> consumers_{ 0 }; // incremented under ReadCoalescer::mtx_
+    };
+
+    // max_shared_bytes: larger files aren't buffered; Open returns null and the caller streams
+    // the file itself.
+    explicit ReadCoalescer(size_t max_shared_bytes = size_t(256) << 20) : max_shared_bytes_(max_shared_bytes) {}
+    // Waits for background reads still running.
+    ~ReadCoalescer();
+
+    // Joins the in-progress read of `path` or starts a new one (call Release() when done with it).
+    // Null if the file can't be stat'ed or is too large to share.
+    std::shared_ptr<SharedRead> Open(const std::filesystem::path& path);
+
+private:
+    void ReadFile(std::string key, std::filesystem::path path, std::shared_ptr<SharedRead> read);
+
+    size_t max_shared_bytes_;
+    mutable std::mutex mtx_;
+    std::condition_variable idle_cv_;
+    std::unordered_map<std::string, std::shared_ptr<SharedRead>> in_flight_;
+    size_t readers_running_ = 0;
+};
\ No newline at end of file
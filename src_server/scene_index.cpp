@@ -0,0 +1,205 @@
+#include "scene_index.h"
+#include "model_loader.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static void HashBytes(uint64_t& h, const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+}
+
+SceneIndex::SceneIndex(std::string media_root, size_t history_limit)
+    : media_root_(std::move(media_root)), history_limit_(std::max<size_t>(1, history_limit)) {
+    // Versions start at the startup time (us) rather than 0, so a version handed out by an earlier
+    // server instance is older than this instance's history and its watcher gets a RESYNC.
+    version_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::vector<std::string> SceneIndex::ListSceneDirs() const {
+    std::vector<std::string> ids;
+    std::error_code ec;
+    for (fs::directory_iterator it(media_root_, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code dir_ec;
+        if (!it->is_directory(dir_ec)) continue;
+        std::string name = it->path().filename().string();
+        if (name.empty() || name[0] == '.') continue; // hidden / internal directories
+        ids.push_back(std::move(name));
+    }
+    return ids;
+}
+
+bool SceneIndex::ScanScene(const std::string& scene_id, SceneEntry& out) const {
+    fs::path dir = fs::path(media_root_) / scene_id;
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) return false;
+
+    struct FileInfo {
+        std::string name;
+        uint64_t size;
+        int64_t mtime;
+    };
+    std::vector<FileInfo> files;
+    out = SceneEntry{};
+    out.scene_id = scene_id;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code file_ec;
+        if (!it->is_regular_file(file_ec)) continue;
+        std::string name = it->path().filename().string();
+        if (name == "thumbnail.png" || name == "thumbnail.jpg" || name == "thumb.png" || name == "thumb.jpg") {
+            out.has_thumbnail = true;
+        }
+        if (ModelLoader::FormatFromName(name) == MeshFormat::Unknown) continue;
+        uint64_t size = static_cast<uint64_t>(it->file_size(file_ec));
+        int64_t mtime = static_cast<int64_t>(it->last_write_time(file_ec).time_since_epoch().count());
+        files.push_back({ std::move(name), size, mtime });
+    }
+    if (ec) return false;
+
+    // Directory order is unspecified; sort so the fingerprint only depends on the contents.
+    std::sort(files.begin(), files.end(), [](const FileInfo& a, const FileInfo& b) { return a.name < b.name; });
+    uint64_t h = 1469598103934665603ull;
+    for (const auto& f : files) {
+        HashBytes(h, f.name.data(), f.name.size() + 1); // include the terminator as a separator
+        HashBytes(h, &f.size, sizeof(f.size));
+        HashBytes(h, &f.mtime, sizeof(f.mtime));
+        out.total_bytes += static_cast<int64_t>(f.size);
+    }
+    out.model_count = static_cast<int32_t>(files.size());
+    out.fingerprint = h;
+    return true;
+}
+
+void SceneIndex::Build(size_t thread_count) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> ids = ListSceneDirs();
+    std::vector<SceneEntry> entries(ids.size());
+    std::vector<char> found(ids.size(), 0);
+
+    // Scenes are independent; directory listing and stat calls parallelize well on large catalogs.
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, std::max<size_t>(1, ids.size()));
+    std::atomic<size_t> next{ 0 };
+    auto work = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < ids.size();) {
+            found[i] = ScanScene(ids[i], entries[i]) ? 1 : 0;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < thread_count; ++t) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+
+    size_t indexed = 0;
+    {
+        std::scoped_lock lk(mtx_);
+        scenes_.clear();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (found[i]) scenes_.emplace(ids[i], std::move(entries[i]));
+        }
+        ++version_;
+        history_.clear(); // watchers from before a rebuild must re-list
+        indexed = scenes_.size();
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[SceneIndex] Indexed " << indexed << " scenes in " << ms << " ms (" << thread_count << " threads)\n";
+}
+
+void SceneIndex::Record(SceneChangeKind kind, const SceneEntry& entry) {
+    SceneIndexChange change;
+    change.version = ++version_;
+    change.kind = kind;
+    change.entry = entry;
+    history_.push_back(std::move(change));
+    while (history_.size() > history_limit_) history_.pop_front();
+}
+
+void SceneIndex::Rescan(const std::vector<std::string>& scene_ids) {
+    // Scan outside the lock; only the comparison and bookkeeping are serialized.
+    std::vector<std::pair<bool, SceneEntry>> scanned;
+    scanned.reserve(scene_ids.size());
+    for (const auto& id : scene_ids) {
+        SceneEntry e;
+        bool exists = !id.empty() && id[0] != '.' && ScanScene(id, e);
+        scanned.emplace_back(exists, std::move(e));
+    }
+
+    size_t recorded = 0;
+    {
+        std::scoped_lock lk(mtx_);
+        for (size_t i = 0; i < scene_ids.size(); ++i) {
+            const std::string& id = scene_ids[i];
+            auto it = scenes_.find(id);
+            if (scanned[i].first) {
+                if (it == scenes_.end()) {
+                    Record(SceneChangeKind::ADDED, scanned[i].second);
+                    scenes_.emplace(id, scanned[i].second);
+                    ++recorded;
+                } else if (!it->second.SameContent(scanned[i].second)) {
+                    Record(SceneChangeKind::CHANGED, scanned[i].second);
+                    it->second = scanned[i].second;
+                    ++recorded;
+                }
+            } else if (it != scenes_.end()) {
+                SceneEntry gone;
+                gone.scene_id = id;
+                Record(SceneChangeKind::REMOVED, gone);
+                scenes_.erase(it);
+                ++recorded;
+            }
+        }
+    }
+    if (recorded > 0) changed_cv_.notify_all();
+}
+
+void SceneIndex::RescanAll() {
+    std::vector<std::string> ids = ListSceneDirs();
+    std::set<std::string> all(ids.begin(), ids.end());
+    for (auto& id : SceneIds()) all.insert(id); // vanished directories become REMOVED
+    Rescan(std::vector<std::string>(all.begin(), all.end()));
+}
+
+std::vector<SceneEntry> SceneIndex::List(const std::string& after_id, size_t limit, std::string& next_after, int64_t& version) const {
+    std::scoped_lock lk(mtx_);
+    std::vector<SceneEntry> out;
+    next_after.clear();
+    version = version_;
+    auto it = after_id.empty() ? scenes_.begin() : scenes_.upper_bound(after_id);
+    for (; it != scenes_.end() && out.size() < limit; ++it) out.push_back(it->second);
+    if (it != scenes_.end() && !out.empty()) next_after = out.back().scene_id;
+    return out;
+}
+
+bool SceneIndex::ChangesSince(int64_t after, std::vector<SceneIndexChange>& out, std::chrono::milliseconds wait) const {
+    std::unique_lock lk(mtx_);
+    if (after > version_) return false; // never issued here: the client saw another server instance
+    changed_cv_.wait_for(lk, wait, [&]() { return version_ > after; });
+    if (version_ <= after) return true; // nothing new
+    // history_ holds a contiguous run of versions ending at version_.
+    int64_t oldest = history_.empty() ? version_ + 1 : history_.front().version;
+    if (after + 1 < oldest) return false;
+    for (const auto& c : history_) {
+        if (c.version > after) out.push_back(c);
+    }
+    return true;
+}
+
+int64_t SceneIndex::Version() const {
+    std::scoped_lock lk(mtx_);
+    return version_;
+}
+
+std::vector<std::string> SceneIndex::SceneIds() const {
+    std::scoped_lock lk(mtx_);
+    std::vector<std::string> ids;
+    ids.reserve(scenes_.size());
+    for (auto& p : scenes_) ids.push_back(p.first);
+    return ids;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Summary of one scene directory under media_root.
+struct SceneEntry {
+    std::string scene_id;
+    int32_t model_count = 0;
+    int64_t total_bytes = 0;
+    uint64_t fingerprint = 0; // FNV-1a over sorted (model name, size, write time)
+    bool has_thumbnail = false;
+
+    bool SameContent(const SceneEntry& o) const {
+        return model_count == o.model_count && total_bytes == o.total_bytes &&
+               fingerprint == o.fingerprint && has_thumbnail == o.has_thumbnail;
+    }
+};
+
+enum class SceneChangeKind { ADDED, CHANGED, REMOVED };
+
+struct SceneIndexChange {
+    int64_t version = 0;
+    SceneChangeKind kind = SceneChangeKind::ADDED;
+    SceneEntry entry;
+};
+
+// In-memory catalog of every scene directory, built by a parallel scan at startup and kept
+// current by Rescan calls (see SceneWatcher). Every change bumps the catalog version and is kept
+// in a bounded history so watchers can resume from the version they last saw. Thread-safe.
+class SceneIndex {
+public:
+    explicit SceneIndex(std::string media_root, size_t history_limit = 4096);
+
+    // Scan every scene directory (thread_count 0 = hardware concurrency). Replaces the contents
+    // without recording changes.
+    void Build(size_t thread_count = 0);
+
+    // Re-scan the given scenes and record ADDED/CHANGED/REMOVED for any that differ.
+    void Rescan(const std::vector<std::string>& scene_ids);
+    // Re-scan everything, including directories that appeared or vanished.
+    void RescanAll();
+
+    // Up to `limit` scenes with id > `after_id`, in id order. `next_after` is set to the last id
+    // returned if more follow, otherwise cleared.
+    std::vector<SceneEntry> List(const std::string& after_id, size_t limit, std::string& next_after, int64_t& version) const;
+
+    // Changes with version > `after`, waiting up to `wait` for the first one. Returns false if
+    // the history no longer reaches back to `after`, or `after` is newer than any version this
+    // index issued (the caller must list again).
+    bool ChangesSince(int64_t after, std::vector<SceneIndexChange>& out, std::chrono::milliseconds wait) const;
+
+    int64_t Version() const;
+    const std::string& MediaRoot() const { return media_root_; }
+    std::vector<std::string> SceneIds() const;
+
+    // Reads one scene directory; false if it doesn't exist (any more).
+    bool ScanScene(const std::string& scene_id, SceneEntry& out) const;
+
+private:
+    std::vector<std::string> ListSceneDirs() const;
+    void Record(SceneChangeKind kind, const SceneEntry& entry); // needs mtx_
+
+    std::string media_root_;
+    size_t history_limit_;
+    mutable std::mutex mtx_;
+    mutable std::condition_variable changed_cv_;
+    std::map<std::string, SceneEntry> scenes_;
+    std::deque<SceneIndexChange> history_;
+    int64_t version_ = 0;
+};
\ No newline at end of file
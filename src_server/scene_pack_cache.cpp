@@ -0,0 +1,52 @@
+#include "scene_pack_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+ScenePackCache::ScenePackCache(const std::string& media_root, bool compress)
+    : root_(fs::path(media_root) / ".packs"), compress_(compress) {}
+
+fs::path ScenePackCache::Get(const std::string& scene_id, const std::string& pack_id, std::vector<PackSource> sources) {
+    fs::path path = root_ / scene_id / (pack_id + ".p4pack");
+    std::error_code ec;
+    {
+        std::unique_lock lk(mtx_);
+        built_cv_.wait(lk, [&]() { return building_.count(scene_id) == 0; });
+        if (fs::exists(path, ec)) return path;
+        building_.insert(scene_id);
+    }
+
+    bool ok = Build(scene_id, std::move(sources), path);
+
+    {
+        std::scoped_lock lk(mtx_);
+        building_.erase(scene_id);
+    }
+    built_cv_.notify_all();
+    return ok ? path : fs::path();
+}
+
+bool ScenePackCache::Build(const std::string& scene_id, std::vector<PackSource> sources, const fs::path& out_path) {
+    auto start = std::chrono::steady_clock::now();
+    // Stable order, so the same files always produce the same pack.
+    std::sort(sources.begin(), sources.end(), [](const PackSource& a, const PackSource& b) { return a.name < b.name; });
+
+    std::string error;
+    std::error_code ec;
+    if (!WriteScenePack(sources, out_path, compress_, error)) {
+        std::cerr << "[ScenePackCache] Failed to pack " << scene_id << ": " << error << "\n";
+        return false;
+    }
+
+    // Packs of earlier versions of the scene are never requested again.
+    for (const auto& de : fs::directory_iterator(out_path.parent_path(), ec)) {
+        if (de.path() != out_path) fs::remove(de.path(), ec);
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "[ScenePackCache] Packed " << scene_id << " (" << sources.size() << " models, "
+              << fs::file_size(out_path, ec) << " bytes) in " << ms << " ms\n";
+    return true;
+}
\ No newline at end of file
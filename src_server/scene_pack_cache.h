@@ -0,0 +1,33 @@
+#pragma once
+
+#include "scene_pack.h"
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Builds and keeps one .p4pack per scene under <media_root>/.packs/<scene_id>/<pack_id>.p4pack,
+// where pack_id identifies the pack's contents (see SceneManifest.pack_id): a pack is rebuilt
+// only after the scene's models change, and older packs of the scene are deleted then. Builds of
+// different scenes run in parallel; concurrent requests for the same scene wait for a single
+// build. Thread-safe.
+class ScenePackCache {
+public:
+    // compress: zlib-compress blobs that shrink noticeably (needs P4_HAVE_ZLIB).
+    ScenePackCache(const std::string& media_root, bool compress);
+
+    // Path of the scene's pack for pack_id, building it from `sources` if needed. Empty if it
+    // can't be built.
+    std::filesystem::path Get(const std::string& scene_id, const std::string& pack_id, std::vector<PackSource> sources);
+
+private:
+    bool Build(const std::string& scene_id, std::vector<PackSource> sources, const std::filesystem::path& out_path);
+
+    std::filesystem::path root_;
+    bool compress_;
+    std::mutex mtx_;
+    std::condition_variable built_cv_;
+    std::set<std::string> building_; // scene ids with a build in progress
+};
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "scene_service_impl.h"
 #include "sceneloader.pb.h"
 #include "sceneloader.grpc.pb.h"
+#include "sha256.h"
+#include "cooked_mesh.h"
+#include "mapped_file.h"
 
 #include <filesystem>
 #include <fstream>
@@ -8,20 +11,139 @@
 #include <thread>
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 
 namespace fs = std::filesystem;
 
-// Constructor: store media root and streaming parameters.
+// Model formats ModelLoader can decode (OBJ text, or binary glTF/PLY/STL).
+static bool IsModelFile(const fs::path& path) {
+    return ModelLoader::FormatFromName(path.filename().string()) != MeshFormat::Unknown;
+}
+
+// Constructor: store media root and streaming parameters, index the catalog and start watching it.
 SceneServiceImpl::SceneServiceImpl(const std::string& media_root, size_t chunk_size, int chunk_delay_ms)
     : media_root_(media_root)
     , chunk_size_(chunk_size)
     , chunk_delay_ms_(chunk_delay_ms)
-{}
+    , blobs_(media_root)
+    , packs_(media_root, /*compress=*/true)
+    , index_(media_root)
+{
+    index_.Build();
+    watcher_.Start();
+}
+
+// Catalog fingerprints double as pack ids, so both are spelled the same way.
+static std::string FingerprintHex(uint64_t fingerprint) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fingerprint));
+    return hex;
+}
+
+static void ToProto(const SceneEntry& e, scene::SceneSummary* out) {
+    out->set_scene_id(e.scene_id);
+    out->set_model_count(e.model_count);
+    out->set_total_bytes(e.total_bytes);
+    out->set_fingerprint(FingerprintHex(e.fingerprint));
+    out->set_has_thumbnail(e.has_thumbnail);
+}
+
+// Bounds of a cooked model, if `path` is a current .p4mesh cooked from `source_hash`. Only the
+// header is read, so cooked models are never parsed here.
+static bool ReadCookedStats(const fs::path& path, const std::string& source_hash, MeshStats& stats) {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) return false;
+    MappedFile file;
+    if (!file.Open(path.string())) return false;
+    CookedMeshInfo info;
+    std::string error;
+    if (!ReadCookedMeshInfo(file.View(), info, error) || info.source_hash != source_hash) return false;
+    stats = info.stats;
+    return true;
+}
+
+// FNV-1a over the (rel_path, hash of what gets packed) pairs in name order, so the id changes
+// exactly when the pack's contents would. Empty if some model has no hash.
+static std::string PackId(const scene::SceneManifest& manifest) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (const auto& mi : manifest.models()) {
+        const std::string& hash = mi.cooked_hash().empty() ? mi.content_hash() : mi.cooked_hash();
+        if (hash.empty()) return std::string();
+        entries.emplace_back(mi.rel_path(), hash);
+    }
+    if (entries.empty()) return std::string();
+    std::sort(entries.begin(), entries.end());
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const std::string& s) {
+        for (char c : s) h = (h ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+        h = (h ^ 0xff) * 1099511628211ull; // separator
+    };
+    for (const auto& [name, hash] : entries) {
+        mix(name);
+        mix(hash);
+    }
+    return FingerprintHex(h);
+}
+
+// Cancelled by the client or past its deadline -> the status to end the call with; OK otherwise.
+static grpc::Status CheckContext(grpc::ServerContext* context) {
+    if (context->IsCancelled()) return grpc::Status(grpc::StatusCode::CANCELLED, "Client cancelled");
+    if (std::chrono::system_clock::now() >= context->deadline()) {
+        return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline exceeded");
+    }
+    return grpc::Status::OK;
+}
+
+// Sleeps in short slices so a cancelled or expired call releases its handler thread promptly.
+static grpc::Status SleepUnlessDone(grpc::ServerContext* context, std::chrono::milliseconds duration) {
+    constexpr auto kSlice = std::chrono::milliseconds(10);
+    auto until = std::chrono::steady_clock::now() + duration;
+    for (;;) {
+        grpc::Status st = CheckContext(context);
+        if (!st.ok()) return st;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= until) return grpc::Status::OK;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(kSlice, until - now));
+    }
+}
+
+static void SetVec3(scene::Vec3* v, const float* xyz) {
+    v->set_x(xyz[0]);
+    v->set_y(xyz[1]);
+    v->set_z(xyz[2]);
+}
 
-// GetSceneManifest: synchronous RPC that enumerates .obj files in the scene folder
-// and returns model metadata and optional thumbnail bytes.
-grpc::Status SceneServiceImpl::GetSceneManifest(grpc::ServerContext* /*context*/, const scene::SceneRequest* request, scene::SceneManifest* response) {
-    const std::string scene_id = request->scene_id();
+// GetSceneManifest: synchronous RPC returning one scene's manifest.
+grpc::Status SceneServiceImpl::GetSceneManifest(grpc::ServerContext* context, const scene::SceneRequest* request, scene::SceneManifest* response) {
+    return BuildManifest(context, request->scene_id(), response);
+}
+
+// GetSceneManifests: the manifests of every requested scene over one stream, written as each is
+// built so the client can start on the first scenes while later ones are still being parsed.
+grpc::Status SceneServiceImpl::GetSceneManifests(grpc::ServerContext* context, const scene::SceneManifestsRequest* request, grpc::ServerWriter<scene::SceneManifestResult>* writer) {
+    for (const auto& scene_id : request->scene_ids()) {
+        scene::SceneManifestResult result;
+        result.set_scene_id(scene_id);
+        grpc::Status st = BuildManifest(context, scene_id, result.mutable_manifest());
+        if (st.error_code() == grpc::StatusCode::NOT_FOUND) {
+            result.clear_manifest();
+        } else if (!st.ok()) {
+            return st;
+        } else {
+            result.set_found(true);
+        }
+        if (!writer->Write(result)) {
+            return grpc::Status(grpc::StatusCode::CANCELLED, "Client stopped reading manifests");
+        }
+    }
+    return grpc::Status::OK;
+}
+
+// BuildManifest: enumerates model files in the scene folder and fills in model metadata
+// (including bounds) and optional thumbnail bytes.
+grpc::Status SceneServiceImpl::BuildManifest(grpc::ServerContext* context, const std::string& scene_id, scene::SceneManifest* response) {
     fs::path scene_dir = fs::path(media_root_) / scene_id;
     if (!fs::exists(scene_dir) || !fs::is_directory(scene_dir)) {
         return grpc::Status(grpc::StatusCode::NOT_FOUND, "Scene not found");
@@ -29,21 +151,79 @@ grpc::Status SceneServiceImpl::GetSceneManifest(grpc::ServerContext* /*context*/
 
     response->set_scene_id(scene_id);
 
-    // enumerate .obj files
+    // enumerate model files
+    std::vector<fs::path> model_paths;
     for (auto const& p : fs::directory_iterator(scene_dir)) {
         if (!p.is_regular_file()) continue;
-        if (p.path().extension() == ".obj") {
+        if (IsModelFile(p.path())) {
             scene::ModelInfo* mi = response->add_models();
             mi->set_name(p.path().stem().string());
             mi->set_rel_path(p.path().filename().string());
             mi->set_size_bytes(static_cast<int64_t>(fs::file_size(p.path())));
+            model_paths.push_back(p.path());
+        }
+    }
+
+    // Content hashes, bounds and triangle counts. Uncached models (first request for a scene, or
+    // edited files) are hashed and parsed in parallel; afterwards this is a cache lookup per
+    // model. Stats are looked up by blob, so a model shared by many scenes is parsed once.
+    // Models cooked by P4_Cook take their stats from the .p4mesh header and are served cooked.
+    std::vector<std::string> hashes(model_paths.size());
+    std::vector<std::string> cooked_hashes(model_paths.size());
+    std::vector<int64_t> cooked_sizes(model_paths.size(), 0);
+    std::vector<MeshStats> stats(model_paths.size());
+    std::vector<char> have_stats(model_paths.size(), 0);
+    std::atomic<size_t> next{ 0 };
+    auto compute = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < model_paths.size();) {
+            if (context->IsCancelled()) return; // nobody is waiting for the parse results
+            hashes[i] = blobs_.Ingest(model_paths[i]);
+            fs::path cooked = hashes[i].empty() ? fs::path() : CookedMeshPath(media_root_, hashes[i]);
+            if (!cooked.empty() && ReadCookedStats(cooked, hashes[i], stats[i])) {
+                cooked_hashes[i] = blobs_.Ingest(cooked);
+                std::error_code ec;
+                cooked_sizes[i] = static_cast<int64_t>(fs::file_size(cooked, ec));
+                if (!cooked_hashes[i].empty() && !ec) {
+                    have_stats[i] = 1;
+                    continue;
+                }
+                cooked_hashes[i].clear();
+                cooked_sizes[i] = 0;
+            }
+            fs::path blob = hashes[i].empty() ? fs::path() : blobs_.PathFor(hashes[i]);
+            have_stats[i] = stats_cache_.Get(blob.empty() ? model_paths[i] : blob, stats[i]) ? 1 : 0;
         }
+    };
+    size_t thread_count = std::min<size_t>(model_paths.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < thread_count; ++t) pool.emplace_back(compute);
+    compute();
+    for (auto& t : pool) t.join();
+    grpc::Status st = CheckContext(context);
+    if (!st.ok()) return st;
+
+    for (size_t i = 0; i < model_paths.size(); ++i) {
+        scene::ModelInfo* mi = response->mutable_models(static_cast<int>(i));
+        mi->set_content_hash(hashes[i]);
+        mi->set_cooked_hash(cooked_hashes[i]);
+        mi->set_cooked_size(cooked_sizes[i]);
+        if (!have_stats[i]) continue;
+        scene::Bounds* b = mi->mutable_bounds();
+        SetVec3(b->mutable_aabb_min(), stats[i].aabb_min);
+        SetVec3(b->mutable_aabb_max(), stats[i].aabb_max);
+        SetVec3(b->mutable_sphere_center(), stats[i].sphere_center);
+        b->set_sphere_radius(stats[i].sphere_radius);
+        mi->set_triangle_count(static_cast<int64_t>(stats[i].triangle_count));
     }
 
-    // include first thumbnail file if present
+    // The pack is built on the first StreamScenePack for this id, not here.
+    response->set_pack_id(PackId(*response));
+
+    // include first thumbnail file if present (the downscaled one from P4_Cook first)
     const std::vector<std::string> thumb_names = { "thumbnail.png", "thumbnail.jpg", "thumb.png", "thumb.jpg" };
-    for (auto const& tn : thumb_names) {
-        fs::path thumb_path = scene_dir / tn;
+    std::vector<fs::path> thumb_paths = { CookedThumbnailPath(media_root_, scene_id) };
+    for (auto const& tn : thumb_names) thumb_paths.push_back(scene_dir / tn);
+    for (auto const& thumb_path : thumb_paths) {
         if (fs::exists(thumb_path) && fs::is_regular_file(thumb_path)) {
             std::ifstream ifs(thumb_path, std::ios::binary);
             if (ifs) {
@@ -58,49 +238,210 @@ grpc::Status SceneServiceImpl::GetSceneManifest(grpc::ServerContext* /*context*/
 }
 
 // StreamModel: server-side streaming RPC that reads a model file in chunks and sends them.
-grpc::Status SceneServiceImpl::StreamModel(grpc::ServerContext* /*context*/, const scene::ModelRequest* request, grpc::ServerWriter<scene::Chunk>* writer) {
-    const std::string scene_id = request->scene_id();
-    const std::string rel_path = request->model_rel_path();
-    fs::path file_path = fs::path(media_root_) / scene_id / rel_path;
+// Models are served from their blob, so concurrent requests for the same content share a single
+// disk read (see ReadCoalescer) even when they name it through different scenes.
+grpc::Status SceneServiceImpl::StreamModel(grpc::ServerContext* context, const scene::ModelRequest* request, grpc::ServerWriter<scene::Chunk>* writer) {
+    fs::path file_path;
+    if (!request->content_hash().empty()) {
+        if (!Sha256::IsHexDigest(request->content_hash())) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed content hash");
+        }
+        file_path = blobs_.PathFor(request->content_hash());
+        if (file_path.empty()) return grpc::Status(grpc::StatusCode::NOT_FOUND, "Blob not found");
+    } else {
+        file_path = fs::path(media_root_) / request->scene_id() / request->model_rel_path();
+        if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "Model not found");
+        }
+        fs::path blob = blobs_.BlobFor(file_path);
+        if (!blob.empty()) file_path = blob;
+    }
+
+    return StreamFile(context, file_path, writer);
+}
+
+// StreamScenePack: the scene's pack (built on first request), whole or a byte range of it. A
+// stale pack id means the scene changed since the client read its manifest.
+grpc::Status SceneServiceImpl::StreamScenePack(grpc::ServerContext* context, const scene::ScenePackRequest* request, grpc::ServerWriter<scene::Chunk>* writer) {
+    const std::string& scene_id = request->scene_id();
+    if (scene_id.empty() || scene_id[0] == '.' || scene_id.find_first_of("/\\") != std::string::npos) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed scene id");
+    }
+    scene::SceneManifest manifest;
+    grpc::Status st = BuildManifest(context, scene_id, &manifest);
+    if (!st.ok()) return st;
+    if (manifest.pack_id().empty() || manifest.pack_id() != request->pack_id()) {
+        return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Pack id is stale; fetch the manifest again");
+    }
 
-    if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
-        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Model not found");
+    // Packs are built from the blobs, so their contents match the hashes the id was made from.
+    std::vector<PackSource> sources;
+    for (const auto& mi : manifest.models()) {
+        fs::path blob = blobs_.PathFor(mi.cooked_hash().empty() ? mi.content_hash() : mi.cooked_hash());
+        if (blob.empty()) return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Scene changed while packing");
+        sources.push_back({ mi.rel_path(), blob });
     }
+    fs::path pack_path = packs_.Get(scene_id, request->pack_id(), sources);
+    if (pack_path.empty()) return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to build scene pack");
+    st = CheckContext(context);
+    if (!st.ok()) return st;
 
+    std::error_code ec;
+    int64_t size = static_cast<int64_t>(fs::file_size(pack_path, ec));
+    if (ec) return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to stat scene pack");
+    int64_t offset = request->offset();
+    int64_t end = request->length() > 0 ? offset + request->length() : size;
+    if (offset < 0 || offset > size || end > size) {
+        return grpc::Status(grpc::StatusCode::OUT_OF_RANGE, "Range outside the scene pack");
+    }
+    // Whole packs are shared between clients loading the same scene; resumed ranges aren't.
+    if (offset == 0 && end == size) return StreamFile(context, pack_path, writer);
+    return StreamFromDisk(context, pack_path, writer, offset, end);
+}
+
+grpc::Status SceneServiceImpl::StreamFile(grpc::ServerContext* context, const fs::path& file_path, grpc::ServerWriter<scene::Chunk>* writer) {
+    std::shared_ptr<ReadCoalescer::SharedRead> shared = reads_.Open(file_path);
+    if (!shared) return StreamFromDisk(context, file_path, writer, 0, -1);
+    // Releasing on every exit lets the shared disk read stop once no stream wants it.
+    struct ReleaseGuard {
+        ReadCoalescer::SharedRead* read;
+        ~ReleaseGuard() { read->Release(); }
+    } release_guard{ shared.get() };
+
+    // Send whatever prefix is already buffered, then follow the reader.
+    auto stop = [context]() { return !CheckContext(context).ok(); };
+    size_t offset = 0;
+    for (;;) {
+        size_t available = shared->WaitForData(offset, stop);
+        if (available == 0) {
+            grpc::Status st = CheckContext(context);
+            if (!st.ok()) return st;
+            break;
+        }
+        size_t n = std::min(available, chunk_size_);
+        grpc::Status st = SendChunk(context, writer, shared->Data() + offset, n, static_cast<int64_t>(offset), shared->Size());
+        if (!st.ok()) return st;
+        offset += n;
+    }
+    if (shared->Failed()) {
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to read file");
+    }
+
+    // final empty chunk marks end
+    scene::Chunk last_chunk;
+    last_chunk.set_offset(static_cast<int64_t>(offset));
+    last_chunk.set_total_size(static_cast<int64_t>(shared->Size()));
+    last_chunk.set_last(true);
+    writer->Write(last_chunk);
+
+    return grpc::Status::OK;
+}
+
+grpc::Status SceneServiceImpl::StreamFromDisk(grpc::ServerContext* context, const fs::path& file_path, grpc::ServerWriter<scene::Chunk>* writer, int64_t offset, int64_t end) {
     std::ifstream ifs(file_path, std::ios::binary);
     if (!ifs) {
-        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to open model file");
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to open file");
     }
+    std::error_code ec;
+    int64_t total = static_cast<int64_t>(fs::file_size(file_path, ec));
+    if (ec) total = 0;
+    if (end < 0) end = total;
+    if (offset > 0) ifs.seekg(offset);
 
     std::vector<char> buffer(chunk_size_);
-    int64_t offset = 0;
 
-    while (ifs && !ifs.eof()) {
-        ifs.read(buffer.data(), static_cast<std::streamsize>(chunk_size_));
+    while (ifs && offset < end) {
+        // Don't read ahead for a client that's gone.
+        grpc::Status st = CheckContext(context);
+        if (!st.ok()) return st;
+
+        size_t want = static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(chunk_size_), end - offset));
+        ifs.read(buffer.data(), static_cast<std::streamsize>(want));
         std::streamsize read_count = ifs.gcount();
         if (read_count <= 0) break;
 
-        scene::Chunk chunk;
-        chunk.set_data(buffer.data(), static_cast<size_t>(read_count));
-        chunk.set_offset(offset);
-        chunk.set_last(false);
-
-        if (!writer->Write(chunk)) {
-            return grpc::Status(grpc::StatusCode::CANCELLED, "Client cancelled streaming");
-        }
-
+        st = SendChunk(context, writer, buffer.data(), static_cast<size_t>(read_count), offset, total);
+        if (!st.ok()) return st;
         offset += static_cast<int64_t>(read_count);
-
-        if (chunk_delay_ms_ > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(chunk_delay_ms_));
-        }
     }
 
     // final empty chunk marks end
     scene::Chunk last_chunk;
     last_chunk.set_offset(offset);
+    last_chunk.set_total_size(total);
     last_chunk.set_last(true);
     writer->Write(last_chunk);
 
     return grpc::Status::OK;
+}
+
+grpc::Status SceneServiceImpl::SendChunk(grpc::ServerContext* context, grpc::ServerWriter<scene::Chunk>* writer, const char* data, size_t size, int64_t offset, int64_t total_size) {
+    grpc::Status st = CheckContext(context);
+    if (!st.ok()) return st;
+
+    scene::Chunk chunk;
+    chunk.set_data(data, size);
+    chunk.set_offset(offset);
+    chunk.set_total_size(total_size);
+    chunk.set_last(false);
+
+    if (!writer->Write(chunk)) {
+        return grpc::Status(grpc::StatusCode::CANCELLED, "Client cancelled streaming");
+    }
+
+    if (chunk_delay_ms_ > 0) {
+        return SleepUnlessDone(context, std::chrono::milliseconds(chunk_delay_ms_));
+    }
+    return grpc::Status::OK;
+}
+
+// ListScenes: one page of the catalog. The page token is the last scene id of the previous page,
+// so pages stay consistent while scenes are added or removed.
+grpc::Status SceneServiceImpl::ListScenes(grpc::ServerContext* /*context*/, const scene::ListScenesRequest* request, scene::ListScenesResponse* response) {
+    constexpr int kDefaultPageSize = 200;
+    constexpr int kMaxPageSize = 1000;
+    int page_size = request->page_size() <= 0 ? kDefaultPageSize : std::min(request->page_size(), kMaxPageSize);
+
+    std::string next;
+    int64_t version = 0;
+    std::vector<SceneEntry> page = index_.List(request->page_token(), static_cast<size_t>(page_size), next, version);
+    for (const auto& e : page) ToProto(e, response->add_scenes());
+    response->set_next_page_token(next);
+    response->set_catalog_version(version);
+    return grpc::Status::OK;
+}
+
+// WatchScenes: stream catalog changes after since_version until the client goes away.
+grpc::Status SceneServiceImpl::WatchScenes(grpc::ServerContext* context, const scene::WatchScenesRequest* request, grpc::ServerWriter<scene::SceneChange>* writer) {
+    int64_t version = request->since_version();
+    std::vector<SceneIndexChange> changes;
+    while (true) {
+        grpc::Status st = CheckContext(context);
+        if (!st.ok()) return st;
+
+        changes.clear();
+        // Short waits so a cancelled watcher frees its thread quickly.
+        if (!index_.ChangesSince(version, changes, std::chrono::milliseconds(500))) {
+            scene::SceneChange resync;
+            resync.set_kind(scene::SceneChange::RESYNC);
+            resync.set_catalog_version(index_.Version());
+            writer->Write(resync);
+            return grpc::Status::OK;
+        }
+        for (const auto& c : changes) {
+            scene::SceneChange msg;
+            switch (c.kind) {
+            case SceneChangeKind::ADDED: msg.set_kind(scene::SceneChange::ADDED); break;
+            case SceneChangeKind::CHANGED: msg.set_kind(scene::SceneChange::CHANGED); break;
+            case SceneChangeKind::REMOVED: msg.set_kind(scene::SceneChange::REMOVED); break;
+            }
+            if (c.kind == SceneChangeKind::REMOVED) msg.mutable_scene()->set_scene_id(c.entry.scene_id);
+            else ToProto(c.entry, msg.mutable_scene());
+            msg.set_catalog_version(c.version);
+            if (!writer->Write(msg)) {
+                return grpc::Status(grpc::StatusCode::CANCELLED, "Client stopped watching");
+            }
+            version = c.version;
+        }
+    }
 }
\ No newline at end of file
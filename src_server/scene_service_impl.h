@@ -1,20 +1,51 @@
 #pragma once
 
 #include "sceneloader.grpc.pb.h"
+#include "blob_store.h"
+#include "model_stats_cache.h"
+#include "read_coalescer.h"
+#include "scene_pack_cache.h"
+#include "scene_index.h"
+#include "scene_watcher.h"
 #include <string>
+#include <filesystem>
 
 class SceneServiceImpl final : public scene::SceneService::Service {
 public:
     // media_root: root directory containing Media/<scene_id>/...
     // chunk_size: bytes per Chunk message
     // chunk_delay_ms: artificial delay (ms) after each chunk to simulate slow network
+    // The scene catalog is indexed here (parallel scan) and watched for changes from then on.
     explicit SceneServiceImpl(const std::string& media_root, size_t chunk_size = 64 * 1024, int chunk_delay_ms = 30);
 
     grpc::Status GetSceneManifest(grpc::ServerContext* context, const scene::SceneRequest* request, scene::SceneManifest* response) override;
+    grpc::Status GetSceneManifests(grpc::ServerContext* context, const scene::SceneManifestsRequest* request, grpc::ServerWriter<scene::SceneManifestResult>* writer) override;
     grpc::Status StreamModel(grpc::ServerContext* context, const scene::ModelRequest* request, grpc::ServerWriter<scene::Chunk>* writer) override;
+    // Builds the scene's pack on first request; supports byte ranges so clients can resume.
+    grpc::Status StreamScenePack(grpc::ServerContext* context, const scene::ScenePackRequest* request, grpc::ServerWriter<scene::Chunk>* writer) override;
+    grpc::Status ListScenes(grpc::ServerContext* context, const scene::ListScenesRequest* request, scene::ListScenesResponse* response) override;
+    // Holds a server thread per watching client for as long as the client stays subscribed.
+    grpc::Status WatchScenes(grpc::ServerContext* context, const scene::WatchScenesRequest* request, grpc::ServerWriter<scene::SceneChange>* writer) override;
 
 private:
+    // Shared by GetSceneManifest and GetSceneManifests; NOT_FOUND if the scene doesn't exist.
+    grpc::Status BuildManifest(grpc::ServerContext* context, const std::string& scene_id, scene::SceneManifest* response);
+    // Sends a whole file through reads_, so concurrent streams of it share one disk read.
+    grpc::Status StreamFile(grpc::ServerContext* context, const std::filesystem::path& file_path, grpc::ServerWriter<scene::Chunk>* writer);
+    // Sends bytes [offset, end) of a file straight from disk (end -1 = to the end of the file);
+    // for files too large to share through reads_ and for partial ranges.
+    grpc::Status StreamFromDisk(grpc::ServerContext* context, const std::filesystem::path& file_path, grpc::ServerWriter<scene::Chunk>* writer, int64_t offset, int64_t end);
+    // Writes one chunk and applies the artificial delay. Non-OK once the client cancelled, its
+    // deadline passed or the write failed; the stream should return that status right away.
+    grpc::Status SendChunk(grpc::ServerContext* context, grpc::ServerWriter<scene::Chunk>* writer, const char* data, size_t size, int64_t offset, int64_t total_size);
+
     std::string media_root_;
     size_t chunk_size_;
     int chunk_delay_ms_;
+    BlobStore blobs_;
+    ModelStatsCache stats_cache_; // keyed by blob path, so shared models are parsed once
+    ScenePackCache packs_;
+    ReadCoalescer reads_;
+    SceneIndex index_;
+    SceneWatcher watcher_{ &index_ };
 };
\ No newline at end of file
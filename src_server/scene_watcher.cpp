@@ -0,0 +1,133 @@
+#include "scene_watcher.h"
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Events for a scene are batched until it has been quiet this long.
+static constexpr auto kQuietPeriod = std::chrono::milliseconds(250);
+// How often the watcher thread checks for Stop while idle.
+static constexpr auto kStopCheck = std::chrono::milliseconds(100);
+
+SceneWatcher::SceneWatcher(SceneIndex* index, std::chrono::milliseconds poll_interval)
+    : index_(index), poll_interval_(poll_interval) {}
+
+SceneWatcher::~SceneWatcher() {
+    Stop();
+}
+
+void SceneWatcher::Start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&SceneWatcher::Run, this);
+}
+
+void SceneWatcher::Stop() {
+    running_.store(false);
+    if (thread_.joinable()) thread_.join();
+}
+
+void SceneWatcher::Run() {
+#ifdef __linux__
+    if (RunInotify()) return;
+    std::cerr << "[SceneWatcher] inotify unavailable, polling every " << poll_interval_.count() << " ms\n";
+#endif
+    RunPolling();
+}
+
+void SceneWatcher::RunPolling() {
+    auto next = std::chrono::steady_clock::now() + poll_interval_;
+    while (running_.load()) {
+        if (std::chrono::steady_clock::now() >= next) {
+            index_->RescanAll();
+            next = std::chrono::steady_clock::now() + poll_interval_;
+        }
+        std::this_thread::sleep_for(kStopCheck);
+    }
+}
+
+#ifdef __linux__
+
+bool SceneWatcher::RunInotify() {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+
+    const std::string root = index_->MediaRoot();
+    constexpr uint32_t kRootMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+    constexpr uint32_t kSceneMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                    IN_ATTRIB | IN_DELETE_SELF | IN_ONLYDIR;
+    int root_wd = inotify_add_watch(fd, root.c_str(), kRootMask);
+    if (root_wd < 0) {
+        close(fd);
+        return false;
+    }
+
+    std::unordered_map<int, std::string> scene_by_wd;
+    auto watch_scene = [&](const std::string& id) {
+        if (id.empty() || id[0] == '.') return;
+        int wd = inotify_add_watch(fd, (fs::path(root) / id).string().c_str(), kSceneMask);
+        if (wd >= 0) scene_by_wd[wd] = id;
+    };
+    for (const auto& id : index_->SceneIds()) watch_scene(id);
+    // A scene created between Build and the root watch would otherwise go unnoticed.
+    index_->RescanAll();
+    for (const auto& id : index_->SceneIds()) watch_scene(id);
+
+    std::set<std::string> dirty;
+    bool rescan_all = false;
+    auto last_event = std::chrono::steady_clock::now();
+    alignas(inotify_event) char buf[16 * 1024];
+
+    while (running_.load()) {
+        pollfd pfd{ fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, static_cast<int>(kStopCheck.count()));
+        if (ready > 0 && (pfd.revents & POLLIN)) {
+            ssize_t len;
+            while ((len = read(fd, buf, sizeof(buf))) > 0) {
+                for (char* p = buf; p < buf + len;) {
+                    auto* ev = reinterpret_cast<inotify_event*>(p);
+                    p += sizeof(inotify_event) + ev->len;
+                    if (ev->mask & IN_Q_OVERFLOW) {
+                        rescan_all = true;
+                        continue;
+                    }
+                    if (ev->wd == root_wd) {
+                        if (ev->len == 0) continue;
+                        std::string id = ev->name;
+                        if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && (ev->mask & IN_ISDIR)) watch_scene(id);
+                        dirty.insert(id);
+                        continue;
+                    }
+                    auto it = scene_by_wd.find(ev->wd);
+                    if (it == scene_by_wd.end()) continue;
+                    dirty.insert(it->second);
+                    if (ev->mask & IN_IGNORED) scene_by_wd.erase(it); // watch removed with its directory
+                }
+            }
+            last_event = std::chrono::steady_clock::now();
+        }
+
+        if ((!dirty.empty() || rescan_all) && std::chrono::steady_clock::now() - last_event >= kQuietPeriod) {
+            if (rescan_all) {
+                index_->RescanAll();
+                for (const auto& id : index_->SceneIds()) watch_scene(id);
+            } else {
+                index_->Rescan(std::vector<std::string>(dirty.begin(), dirty.end()));
+            }
+            dirty.clear();
+            rescan_all = false;
+        }
+    }
+
+    close(fd);
+    return true;
+}
+
+#endif
\ No newline at end of file
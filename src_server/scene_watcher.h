@@ -0,0 +1,32 @@
+#pragma once
+
+#include "scene_index.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Keeps a SceneIndex current. On Linux it uses inotify (media_root plus one watch per scene
+// directory) and re-scans only the scenes that saw events, after a short quiet period so a
+// multi-file copy is reported once. Elsewhere, or if inotify is unavailable, it re-scans the
+// whole catalog every poll_interval.
+class SceneWatcher {
+public:
+    explicit SceneWatcher(SceneIndex* index, std::chrono::milliseconds poll_interval = std::chrono::seconds(2));
+    ~SceneWatcher();
+
+    void Start();
+    void Stop();
+
+private:
+    void Run();
+    void RunPolling();
+#ifdef __linux__
+    // Returns false if inotify can't be set up (caller falls back to polling).
+    bool RunInotify();
+#endif
+
+    SceneIndex* index_;
+    std::chrono::milliseconds poll_interval_;
+    std::atomic<bool> running_{ false };
+    std::thread thread_;
+};
\ No newline at end of file